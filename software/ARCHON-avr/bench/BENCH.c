@@ -0,0 +1,301 @@
+/** @file BENCH.c
+ *  @brief Cycle-count benchmarks for ARCHON kernels.
+ *
+ *  This contains the implementation for the interface described in `BENCH.h`,
+ *  along with the benchmarks themselves. Each module gets its own section and
+ *  `bch_<module>()` function, called in order from `main()`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <stdint.h>
+
+#include "BENCH.h"
+#include "COLOR.h"
+#include "MATH8.h"
+#include "RGB_LED.h"
+#include "UART.h"
+#include "VM.h"
+
+
+/* -- VARIABLES -- */
+
+// Keeps results from being optimized away
+static volatile uint8_t bch_sink;
+
+
+/* -- FUNCTION DECLARATIONS -- */
+
+static void bch_mth(void);
+static void bch_mth_check(void);
+static void bch_rgb(void);
+static void bch_clr(void);
+static void bch_vm(void);
+
+
+/* -- BODY -- */
+
+int main(void) {
+  cli();
+  rgb_init();
+  bch_init();
+
+  bch_mth();
+  bch_mth_check();
+  bch_rgb();
+  bch_clr();
+  bch_vm();
+
+  BCH_PRINT("done", 0);
+  while (1) { }
+
+  return 0;
+}
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void bch_init(void) {
+  urt_init(BCH_BAUD);
+
+  TCCR1A = 0;
+  TCCR1B = (1 << CS11);
+  TIMSK1 = 0;
+}
+
+void bch_print(const char *_name, uint32_t _value) {
+  char _digits[10];
+  uint8_t _len = 0;
+  char _char;
+
+  while ((_char = pgm_read_byte(_name++))) {
+    urt_send_block(_char);
+  }
+  urt_send_block(':');
+  urt_send_block(' ');
+
+  if (_value == BCH_OVERFLOW) {
+    urt_send_block('-');
+  } else {
+    do {
+      _digits[_len++] = '0' + (_value % 10);
+      _value /= 10;
+    } while (_value);
+
+    while (_len) {
+      urt_send_block(_digits[--_len]);
+    }
+  }
+
+  urt_send_block('\r');
+  urt_send_block('\n');
+}
+
+
+/* -- MATH8 -- */
+
+// Time BCH_REPS calls of `_expr` (which may use `_rep`), and print the average
+#define BCH_KERNEL(_name, _expr) do {                                         \
+    bch_start();                                                              \
+    for (uint16_t _rep = 0; _rep < BCH_REPS; _rep++) {                        \
+      bch_sink = (_expr);                                                     \
+    }                                                                         \
+    BCH_PRINT(_name " [cycles/call]", bch_per(bch_stop(), BCH_REPS));         \
+  } while (0)
+
+static void bch_mth(void) {
+  // Inputs change every call, so nothing can be hoisted out of the loop
+  BCH_KERNEL("mth_scale8", mth_scale8(_rep, _rep >> 1));
+  BCH_KERNEL("mth_scale8_video", mth_scale8_video(_rep, _rep >> 1));
+  BCH_KERNEL("mth_qadd8", mth_qadd8(_rep, 200));
+  BCH_KERNEL("mth_qsub8", mth_qsub8(_rep, 50));
+  BCH_KERNEL("mth_blend8", mth_blend8(_rep, ~_rep, _rep >> 1));
+  BCH_KERNEL("mth_scale16", mth_scale16(_rep * 257, _rep * 251) >> 8);
+  BCH_KERNEL("mth_lerp16", mth_lerp16(1000, _rep * 251, _rep * 257) >> 8);
+  BCH_KERNEL("mth_random8", mth_random8());
+  BCH_KERNEL("mth_random16", mth_random16() >> 8);
+}
+
+// Count the inputs `_a`, `_b` where `_expr` and `_ref` differ, over every
+// pair of 8-bit values, and print the count
+#define BCH_CHECK8(_name, _expr, _ref) do {                                   \
+    uint32_t _errors = 0;                                                     \
+    uint16_t _pair = 0;                                                       \
+    do {                                                                      \
+      uint8_t _a = _pair >> 8;                                                \
+      uint8_t _b = _pair;                                                     \
+      if ((_expr) != (_ref)) {                                                \
+        _errors++;                                                            \
+      }                                                                       \
+    } while (++_pair);                                                        \
+    BCH_PRINT(_name " [mismatches]", _errors);                                \
+  } while (0)
+
+// Values that take the carry and zero paths of the 16-bit kernels
+static const uint16_t BCH_EDGES[] = {0, 1, 0x00FF, 0x0100, 0x7FFF, 0x8000,
+                                     0xFF00, 0xFFFE, 0xFFFF};
+#define BCH_NUM_EDGES (sizeof(BCH_EDGES) / sizeof(BCH_EDGES[0]))
+
+static void bch_mth_check(void) {
+  BCH_CHECK8("mth_scale8", mth_scale8(_a, _b), mth_scale8_ref(_a, _b));
+  BCH_CHECK8("mth_scale8_video", mth_scale8_video(_a, _b),
+             mth_scale8_video_ref(_a, _b));
+  BCH_CHECK8("mth_qadd8", mth_qadd8(_a, _b), mth_qadd8_ref(_a, _b));
+  BCH_CHECK8("mth_qsub8", mth_qsub8(_a, _b), mth_qsub8_ref(_a, _b));
+  // Every start value and amount, towards both ends and somewhere between
+  BCH_CHECK8("mth_blend8 to 0", mth_blend8(_a, 0, _b),
+             mth_blend8_ref(_a, 0, _b));
+  BCH_CHECK8("mth_blend8 to 255", mth_blend8(_a, 255, _b),
+             mth_blend8_ref(_a, 255, _b));
+  BCH_CHECK8("mth_blend8 to ~a", mth_blend8(_a, ~_a, _b),
+             mth_blend8_ref(_a, ~_a, _b));
+
+  uint32_t _scale16_errors = 0;
+  uint32_t _lerp16_errors = 0;
+
+  for (uint8_t _i = 0; _i < BCH_NUM_EDGES; _i++) {
+    for (uint8_t _j = 0; _j < BCH_NUM_EDGES; _j++) {
+      uint16_t _x = BCH_EDGES[_i];
+      uint16_t _y = BCH_EDGES[_j];
+      if (mth_scale16(_x, _y) != mth_scale16_ref(_x, _y)) {
+        _scale16_errors++;
+      }
+      if (mth_lerp16(_x, _y, _x ^ _y) != mth_lerp16_ref(_x, _y, _x ^ _y)) {
+        _lerp16_errors++;
+      }
+    }
+  }
+  for (uint16_t _rep = 0; _rep < BCH_SAMPLES; _rep++) {
+    uint16_t _x = mth_random16();
+    uint16_t _y = mth_random16();
+    uint16_t _frac = mth_random16();
+    if (mth_scale16(_x, _frac) != mth_scale16_ref(_x, _frac)) {
+      _scale16_errors++;
+    }
+    if (mth_lerp16(_x, _y, _frac) != mth_lerp16_ref(_x, _y, _frac)) {
+      _lerp16_errors++;
+    }
+  }
+  BCH_PRINT("mth_scale16 [mismatches]", _scale16_errors);
+  BCH_PRINT("mth_lerp16 [mismatches]", _lerp16_errors);
+}
+
+
+/* -- RGB_LED -- */
+
+static void bch_rgb(void) {
+  uint32_t _cycles;
+
+  bch_start();
+  for (uint16_t _rep = 0; _rep < BCH_REPS; _rep++) {
+    bch_sink = rgb_correct((uint8_t)_rep, gam_red);
+  }
+  _cycles = bch_stop();
+  BCH_PRINT("rgb_correct [cycles/channel]", bch_per(_cycles, BCH_REPS));
+
+#ifdef RGB_DITHER
+  uint8_t _err = 0;
+
+  bch_start();
+  for (uint16_t _rep = 0; _rep < BCH_REPS; _rep++) {
+    bch_sink = rgb_dither((uint8_t)_rep, 0x80, &_err, gam_red);
+  }
+  _cycles = bch_stop();
+  BCH_PRINT("rgb_dither [cycles/channel]", bch_per(_cycles, BCH_REPS));
+#endif /* RGB_DITHER */
+
+  // Something other than all-zero, so every bit path is taken
+  for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+    rgb_set(_led, (rgb_t){.red = _led, .green = ~_led, .blue = 0x55});
+  }
+
+  bch_start();
+  rgb_push();
+  _cycles = bch_stop();
+  BCH_PRINT("rgb_push [cycles/LED]", bch_per(_cycles, RGB_CHAIN_LEDS));
+
+#if RGB_DRIVER == RGB_WS2812
+  // Each bit is at least one SPI byte at F_CPU / 4
+  BCH_PRINT("rgb_push budget [cycles/LED]", sizeof(rgb_t) * 8 * 32);
+#endif /* RGB_DRIVER */
+}
+
+
+/* -- COLOR -- */
+
+static void bch_clr(void) {
+  uint32_t _cycles;
+  hsv_t _hsv = {.sat = 200, .val = 180};
+  rgb_t _px;
+
+  // Every hue, so every sector is taken
+  bch_start();
+  for (uint16_t _rep = 0; _rep < BCH_REPS; _rep++) {
+    _hsv.hue = _rep;
+    _px = clr_hsv(_hsv);
+    bch_sink = _px.red ^ _px.green ^ _px.blue;
+  }
+  _cycles = bch_stop();
+  BCH_PRINT("clr_hsv [cycles/pixel]", bch_per(_cycles, BCH_REPS));
+}
+
+
+/* -- VM -- */
+
+// Rainbow - a sine per channel, per LED. See `tools/vmasm.py`.
+//         NLEDS r2
+//         TIME  r1
+//         SHR   r1, 2
+//         LDI   r0, 0
+//         LDI   r7, 85
+//         LDI   r8, 8
+// loop:   MOV   r3, r1
+//         SIN   r4, r3
+//         ADD   r3, r7
+//         SIN   r5, r3
+//         ADD   r3, r7
+//         SIN   r6, r3
+//         SET   r0, r4, r5, r6
+//         INC   r0
+//         ADD   r1, r8
+//         JLT   r0, r2, loop
+//         END
+static const uint8_t BCH_VM_RAINBOW[] = {
+  0x0C, 0x20, 0x0B, 0x10, 0x07, 0x12, 0x01, 0x00, 0x00, 0x00, 0x01, 0x70,
+  0x55, 0x00, 0x01, 0x80, 0x08, 0x00, 0x02, 0x31, 0x0A, 0x43, 0x03, 0x37,
+  0x0A, 0x53, 0x03, 0x37, 0x0A, 0x63, 0x10, 0x04, 0x56, 0x09, 0x00, 0x03,
+  0x18, 0x0E, 0x02, 0x12, 0x00,
+};
+
+static void bch_vm(void) {
+  uint32_t _cycles;
+  uint32_t _push;
+  uint16_t _steps;
+
+  vm_write(0, BCH_VM_RAINBOW, sizeof(BCH_VM_RAINBOW));
+
+  bch_start();
+  _steps = vm_run();
+  _cycles = bch_stop();
+  BCH_PRINT("vm_run rainbow [instructions/frame]", _steps);
+  BCH_PRINT("vm_run rainbow [cycles/frame]", _cycles);
+  if (_cycles == BCH_OVERFLOW) {
+    return;
+  }
+  _cycles /= _steps;
+  BCH_PRINT("vm_run [cycles/instruction]", _cycles);
+
+  // Whatever a frame doesn't spend pushing is left for the program
+  rgb_invalidate();
+  bch_start();
+  rgb_push();
+  _push = bch_stop();
+  if (_push != BCH_OVERFLOW) {
+    BCH_PRINT("vm budget at VM_FRAME_MS [instructions/frame]",
+              (F_CPU / 1000 * VM_FRAME_MS - _push) / _cycles);
+  }
+}
@@ -0,0 +1,110 @@
+/** @file BENCH.h
+ *  @brief Cycle-count benchmarks for ARCHON kernels.
+ *
+ *  Built as a separate firmware image with `make bench` (and flashed with
+ *  `make install_bench`). It links against everything in `src/` except
+ *  `ARCHON.c`, runs each benchmark once with interrupts disabled, and prints
+ *  the results over UART as plain text at BCH_BAUD. Read them with any serial
+ *  terminal.
+ *
+ *  Cycles are counted on TIMER1 at F_CPU / 8, so a single measurement is good
+ *  to 8 cycles and overflows after 524288 cycles (~32 ms). Per-call figures
+ *  are averaged over BCH_REPS calls and include the loop overhead (~5
+ *  cycles).
+ *
+ *  The MATH8 assembly is also checked against its C reference: every input
+ *  pair for the 8-bit kernels, and BCH_SAMPLES random inputs (plus the
+ *  edges) for the 16-bit ones. Each prints its mismatch count, which should
+ *  be 0.
+ *
+ *  NOTE: In RGB_DUAL_CHAIN builds, USART0 is taken back for output after
+ *        `rgb_init()`. Timings are unaffected, but the second chain will
+ *        show garbage.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <stdint.h>
+
+
+/* -- CONFIGURATION -- */
+
+#define BCH_BAUD      9600UL // [baud]
+#define BCH_PRESCALER 8
+#define BCH_REPS      256
+#define BCH_SAMPLES   32768 // Random inputs per 16-bit MATH8 check
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// Returned by `bch_stop()` when TIMER1 overflowed
+#define BCH_OVERFLOW  UINT32_MAX
+
+// Print a result with the name kept in flash
+#define BCH_PRINT(_name, _value) bch_print(PSTR(_name), _value)
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Initialize UART for output and TIMER1 for counting.
+ *
+ *  @returns Void.
+ */
+void bch_init(void);
+
+/** @brief Print one result as "<name>: <value>\r\n".
+ *
+ *  Blocks until the whole line is sent.
+ *
+ *  @param _name Name of the result, in PROGMEM
+ *  @param _value Result to print, or BCH_OVERFLOW
+ *  @returns Void.
+ */
+void bch_print(const char *_name, uint32_t _value);
+
+/** @brief Start counting cycles.
+ *
+ *  @returns Void.
+ */
+static inline void bch_start(void) {
+  TCNT1 = 0;
+  TIFR1 = (1 << TOV1);
+}
+
+/** @brief Stop counting cycles.
+ *
+ *  @returns Cycles since `bch_start()`, or BCH_OVERFLOW
+ */
+static inline uint32_t bch_stop(void) {
+  uint16_t _ticks = TCNT1;
+
+  if (TIFR1 & (1 << TOV1)) {
+    return BCH_OVERFLOW;
+  }
+
+  return (uint32_t)_ticks * BCH_PRESCALER;
+}
+
+/** @brief Divide a cycle count among the work it covered.
+ *
+ *  @param _cycles Result of `bch_stop()`
+ *  @param _count Calls, LEDs, etc. timed
+ *  @returns Cycles per `_count`, or BCH_OVERFLOW if `_cycles` is
+ */
+static inline uint32_t bch_per(uint32_t _cycles, uint16_t _count) {
+  if (_cycles == BCH_OVERFLOW) {
+    return BCH_OVERFLOW;
+  }
+
+  return _cycles / _count;
+}
+
+
+#endif /* BENCH_H */
@@ -0,0 +1,120 @@
+/** @file ANIM.c
+ *  @brief Flash-resident animation playback
+ *
+ *  This contains the implementation for the interface described in `ANIM.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "ANIM.h"
+
+
+/* -- VARIABLES -- */
+
+#define ANM_VALID 0xA5 // Anything but blank EEPROM
+
+static uint16_t anm_pos;
+static uint16_t anm_frame_ms;
+static uint8_t anm_running = 0;
+static uint32_t anm_last;
+
+static uint8_t EEMEM anm_power_on_ee;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void anm_init(void) {
+  if (eeprom_read_byte(&anm_power_on_ee) == ANM_VALID) {
+    anm_start();
+  }
+}
+
+void anm_start(void) {
+  anm_pos = 0;
+  anm_frame_ms = (uint16_t)anm_read() << 8;
+  anm_frame_ms |= anm_read();
+  anm_running = 1;
+}
+
+void anm_stop(void) {
+  anm_running = 0;
+}
+
+void anm_set_power_on(uint8_t _enable) {
+  eeprom_update_byte(&anm_power_on_ee, _enable ? ANM_VALID : 0);
+}
+
+uint8_t anm_update(uint32_t _now) {
+  if (!anm_running || (_now - anm_last) < anm_frame_ms) {
+    return 0;
+  }
+  anm_last = _now;
+
+  if (!anm_decode()) {
+    anm_running = 0;
+    return 0;
+  }
+
+  return 1;
+}
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+static inline uint8_t anm_read(void) {
+  return pgm_read_byte(&anm_stream[anm_pos++]);
+}
+
+static rgb_t anm_read_colour(void) {
+  rgb_t _colour = {0};
+  _colour.red = anm_read();
+  _colour.green = anm_read();
+  _colour.blue = anm_read();
+  return _colour;
+}
+
+static uint8_t anm_decode(void) {
+  uint16_t _led = 0;
+
+  while (1) {
+    uint8_t _op = anm_read();
+    uint8_t _count = (_op & ANM_COUNT_MASK) + 1;
+
+    if (_op == ANM_END) {
+      // Nothing between the header and the end - nothing to play
+      if (anm_pos == ANM_HEADER_SIZE + 1) {
+        return 0;
+      }
+      anm_pos = ANM_HEADER_SIZE;
+      continue;
+    }
+
+    switch (_op & ~ANM_COUNT_MASK) {
+      case ANM_SKIP: {
+        _led += _count;
+      } break;
+      case ANM_RUN: {
+        rgb_t _colour = anm_read_colour();
+        for (; _count; _count--, _led++) {
+          if (_led < rgb_num_leds) {
+            rgb_set(_led, _colour);
+          }
+        }
+      } break;
+      case ANM_LITERAL: {
+        for (; _count; _count--, _led++) {
+          rgb_t _colour = anm_read_colour();
+          if (_led < rgb_num_leds) {
+            rgb_set(_led, _colour);
+          }
+        }
+      } break;
+      // ANM_FRAME
+      default: {
+        return 1;
+      }
+    }
+  }
+}
@@ -0,0 +1,116 @@
+/** @file ANIM.h
+ *  @brief Flash-resident animation playback
+ *
+ *  Plays an animation compiled into flash (`anm_stream`, in ANIM_DATA.c),
+ *  so long loops can run with no host and no SRAM beyond `rgb_led`. The
+ *  stream is generated from a frame file by `tools/anim.py` (`make anim`),
+ *  and decoded one frame at a time, straight into the LEDs.
+ *
+ *  The stream starts with the frame time (2 bytes, high byte first [ms]),
+ *  then each frame as a list of ops, each on the LEDs after the last:
+ *
+ *  | Op          | Byte       | Then              | Effect                   |
+ *  |-------------|------------|-------------------|--------------------------|
+ *  | ANM_SKIP    | 0b00nnnnnn |                   | n + 1 LEDs unchanged     |
+ *  | ANM_RUN     | 0b01nnnnnn | R, G, B           | n + 1 LEDs set to RGB    |
+ *  | ANM_LITERAL | 0b10nnnnnn | (R, G, B) x n + 1 | n + 1 LEDs set, in turn  |
+ *  | ANM_FRAME   | 0xC0       |                   | End of frame             |
+ *  | ANM_END     | 0xFF       |                   | Loop back to the start   |
+ *
+ *  LEDs a frame doesn't reach are left alone, so frames after the first
+ *  only need to hold what changed. The first frame must set every LED.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <stdint.h>
+
+#include "RGB_LED.h"
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+#define ANM_HEADER_SIZE 2
+#define ANM_COUNT_MASK  0x3F
+
+typedef enum anm_op {
+  ANM_SKIP = 0x00,
+  ANM_RUN = 0x40,
+  ANM_LITERAL = 0x80,
+  ANM_FRAME = 0xC0,
+  ANM_END = 0xFF,
+} anm_op_t;
+
+// Compressed animation, from `tools/anim.py`
+extern const uint8_t anm_stream[] PROGMEM;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Start playing, if set to play at power on
+ *
+ *  @returns Void.
+ */
+void anm_init(void);
+
+/** @brief Play the animation from the first frame
+ *
+ *  @returns Void.
+ */
+void anm_start(void);
+
+/** @brief Stop playing, leaving the current frame up
+ *
+ *  @returns Void.
+ */
+void anm_stop(void);
+
+/** @brief Choose whether to play at power on, and save it to EEPROM
+ *
+ *  @param _enable 1 to play at power on, 0 not to
+ *  @returns Void.
+ */
+void anm_set_power_on(uint8_t _enable);
+
+/** @brief Draw the next frame, if one is due
+ *
+ *  Call as often as possible. Draws at most one frame per frame time. Does
+ *  not push.
+ *
+ *  @param _now Current time, from `millis()` [ms]
+ *  @returns 1 if a frame was drawn (and should be pushed), 0 otherwise
+ */
+uint8_t anm_update(uint32_t _now);
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+/** @brief Read the next byte of the stream
+ *
+ *  @returns The byte
+ */
+static inline uint8_t anm_read(void);
+
+/** @brief Read the next colour of the stream
+ *
+ *  @returns The colour
+ */
+static rgb_t anm_read_colour(void);
+
+/** @brief Decode one frame into the LEDs
+ *
+ *  Loops back to the first frame at ANM_END.
+ *
+ *  @returns 1 if a frame was drawn, 0 if the stream has no frames
+ */
+static uint8_t anm_decode(void);
+
+
+#endif /* ANIM_H */
@@ -0,0 +1,61 @@
+/** @file ANIM_DATA.c
+ *  @brief Flash-resident animation.
+ *
+ *  This contains the stream described in `ANIM.h`.
+ *
+ *  NOTE: Generated by `tools/anim.py` - do not edit by hand. Source:
+ *        tools/comet.txt, 20 frames of 20 LEDs at 40 ms,
+ *        501 bytes (1200 uncompressed)
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "ANIM.h"
+
+
+const uint8_t anm_stream[] PROGMEM = {
+  0x00, 0x28, 0x80, 0xFF, 0x60, 0x00, 0x4D, 0x00, 0x00, 0x00, 0x84, 0x08,
+  0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00, 0x80,
+  0x30, 0x00, 0xC0, 0x81, 0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x0C, 0x84,
+  0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00,
+  0x40, 0x18, 0x00, 0xC0, 0x82, 0x40, 0x18, 0x00, 0x80, 0x30, 0x00, 0xFF,
+  0x60, 0x00, 0x0C, 0x83, 0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0x10, 0x06,
+  0x00, 0x20, 0x0C, 0x00, 0xC0, 0x83, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00,
+  0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x0C, 0x82, 0x00, 0x00, 0x00, 0x08,
+  0x03, 0x00, 0x10, 0x06, 0x00, 0xC0, 0x84, 0x10, 0x06, 0x00, 0x20, 0x0C,
+  0x00, 0x40, 0x18, 0x00, 0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x0C, 0x81,
+  0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0xC0, 0x85, 0x08, 0x03, 0x00, 0x10,
+  0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00, 0x80, 0x30, 0x00, 0xFF,
+  0x60, 0x00, 0x0C, 0x80, 0x00, 0x00, 0x00, 0xC0, 0x86, 0x00, 0x00, 0x00,
+  0x08, 0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00,
+  0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x0C, 0xC0, 0x00, 0x86, 0x00, 0x00,
+  0x00, 0x08, 0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18,
+  0x00, 0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x0B, 0xC0, 0x01, 0x86, 0x00,
+  0x00, 0x00, 0x08, 0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00, 0x40,
+  0x18, 0x00, 0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x0A, 0xC0, 0x02, 0x86,
+  0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00,
+  0x40, 0x18, 0x00, 0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x09, 0xC0, 0x03,
+  0x86, 0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C,
+  0x00, 0x40, 0x18, 0x00, 0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x08, 0xC0,
+  0x04, 0x86, 0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0x10, 0x06, 0x00, 0x20,
+  0x0C, 0x00, 0x40, 0x18, 0x00, 0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x07,
+  0xC0, 0x05, 0x86, 0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0x10, 0x06, 0x00,
+  0x20, 0x0C, 0x00, 0x40, 0x18, 0x00, 0x80, 0x30, 0x00, 0xFF, 0x60, 0x00,
+  0x06, 0xC0, 0x06, 0x86, 0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0x10, 0x06,
+  0x00, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00, 0x80, 0x30, 0x00, 0xFF, 0x60,
+  0x00, 0x05, 0xC0, 0x07, 0x86, 0x00, 0x00, 0x00, 0x08, 0x03, 0x00, 0x10,
+  0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00, 0x80, 0x30, 0x00, 0xFF,
+  0x60, 0x00, 0x04, 0xC0, 0x08, 0x86, 0x00, 0x00, 0x00, 0x08, 0x03, 0x00,
+  0x10, 0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00, 0x80, 0x30, 0x00,
+  0xFF, 0x60, 0x00, 0x03, 0xC0, 0x09, 0x86, 0x00, 0x00, 0x00, 0x08, 0x03,
+  0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00, 0x80, 0x30,
+  0x00, 0xFF, 0x60, 0x00, 0x02, 0xC0, 0x0A, 0x86, 0x00, 0x00, 0x00, 0x08,
+  0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00, 0x80,
+  0x30, 0x00, 0xFF, 0x60, 0x00, 0x01, 0xC0, 0x0B, 0x86, 0x00, 0x00, 0x00,
+  0x08, 0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18, 0x00,
+  0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0x00, 0xC0, 0x0C, 0x86, 0x00, 0x00,
+  0x00, 0x08, 0x03, 0x00, 0x10, 0x06, 0x00, 0x20, 0x0C, 0x00, 0x40, 0x18,
+  0x00, 0x80, 0x30, 0x00, 0xFF, 0x60, 0x00, 0xC0, 0xFF,
+};
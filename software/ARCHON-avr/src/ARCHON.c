@@ -12,15 +12,38 @@
 #include <stdint.h>
 #include <util/delay.h>
 
+#include "ANIM.h"
+#include "COLOR.h"
 #include "COMM.h"
+#include "EFFECT.h"
+#include "EVENT.h"
+#include "FADE.h"
+#include "FRAME.h"
+#include "MATRIX.h"
+#include "MICROS_TIMER.h"
 #include "MILLIS_TIMER.h"
+#include "PROFILE.h"
+#include "QUEUE.h"
 #include "RGB_LED.h"
-#include "UART.h"
+#include "SCENE.h"
+#include "SEGMENT.h"
+#include "TASK.h"
+#include "VM.h"
 
 
 /*** CONFIGURATION ***/
 
 #define BAUD_RATE 9600UL // [baud]
+#define DRAW_PERIOD_MS 1 // [ms]
+#define SRAM_RESERVE 768 // [bytes] - stack, COMM, VM, tasks and the rest
+
+// Per-LED buffers, against the SRAM left over
+#define LED_SRAM_BYTES (RGB_SRAM_BYTES + FAD_SRAM_BYTES + QUE_SRAM_BYTES \
+                        + EFX_SRAM_BYTES)
+
+#if LED_SRAM_BYTES > RAMEND - RAMSTART + 1 - SRAM_RESERVE
+  #error "SRAM is full - lower RGB_NUM_LEDS (or drop a layer)"
+#endif /* LED_SRAM_BYTES */
 
 
 /*** VARIABLES ***/
@@ -31,10 +54,17 @@ const com_message_t READY_MSG = {.type = COM_PKT_READY};
 uint8_t g_msg_ok_to_send = 0;
 uint16_t g_led_block = 0;
 
+uint8_t g_refresh_task = TSK_NONE;
+
 /*** FUNCTION DECLARATIONS ***/
 
 void init_all(void);
+void draw_task(void);
+void refresh_task(void);
+uint8_t link_idle(void);
+uint16_t led_index(uint8_t _led);
 void process_incoming_message(void);
+void push_frame(void);
 void push_to_led(void);
 
 /*** BODY ***/
@@ -43,12 +73,40 @@ int main(void) {
   // Setup all devices
   init_all();
 
+  // Light up straight away, without waiting for the host
+  if (scn_load_power_on()) {
+    rgb_push();
+  }
+
   sei();
 
+  uint8_t _tasks = 0;
   while(1) {
+    uint8_t _events = evt_take();
+
     // Check for finished incoming messages.
-    if (com_status & (1 << COM_RX_READY)) {
+    if ((_events & (1 << EVT_COMM))
+        && (com_status & (1 << COM_RX_READY))) {
+      PRF_BEGIN(PRF_PACKET);
       process_incoming_message();
+      PRF_END(PRF_PACKET);
+    }
+
+    // At a fixed frame rate, push whatever changed once each frame is due -
+    // or once the link is idle, if it had to wait
+    if (_events & ((1 << EVT_FRAME) | (1 << EVT_COMM))) {
+      frm_update(link_idle());
+    }
+
+    // One task at a time, so packets are checked in between. Keep going
+    // while they run, as more may be due.
+    if ((_events & (1 << EVT_TICK)) || _tasks) {
+      _tasks = tsk_run(millis());
+    }
+
+    // Nothing left until the next interrupt
+    if (!_tasks) {
+      evt_sleep();
     }
   }
 
@@ -65,8 +123,84 @@ int main(void) {
  */
 void init_all(void) {
   rgb_init();
+#ifdef RGB_MATRIX
+  mtx_init();
+#endif /* RGB_MATRIX */
+  vm_init();
+  anm_init();
+  seg_init();
   tmr_millis_init();
-  urt_init(BAUD_RATE);
+  tmr_millis_start();
+  tmr_micros_init();
+  tmr_micros_start();
+  prf_init();
+  com_init(BAUD_RATE);
+  tsk_add(draw_task, 0, DRAW_PERIOD_MS, millis());
+}
+
+/** @brief Draw and push effect, VM, fade, animation and queued frames
+ *
+ *  Run every DRAW_PERIOD_MS. Each module keeps its own frame timing. Frames
+ *  are never pushed in the middle of a packet - they wait for the next run.
+ *
+ *  @returns Void.
+ */
+void draw_task(void) {
+  if (!link_idle()) {
+    return;
+  }
+  if (efx_update(millis())) {
+    push_frame();
+  }
+  if (vm_update(millis())) {
+    push_frame();
+  }
+#ifndef RGB_NO_FADE
+  if (fad_update(millis())) {
+    push_frame();
+  }
+#endif /* RGB_NO_FADE */
+  if (anm_update(millis())) {
+    push_frame();
+  }
+#ifdef RGB_QUEUE
+  if (que_update(millis())) {
+    push_frame();
+  }
+#endif /* RGB_QUEUE */
+}
+
+/** @brief Push every LED again, for AUTO_REFRESH
+ *
+ *  Skipped in the middle of a packet.
+ *
+ *  @returns Void.
+ */
+void refresh_task(void) {
+  if (link_idle()) {
+    rgb_invalidate();
+    push_frame();
+  }
+}
+
+/** @brief Check that no packet is on the wire
+ *
+ *  `rgb_push()` disables interrupts, so unsolicited pushes (auto-refresh,
+ *  effects) wait for this to avoid dropping bytes.
+ *
+ *  @returns 1 if nothing is being sent or received, 0 otherwise
+ */
+uint8_t link_idle(void) {
+  return !(com_status & ((1 << COM_RX_BUSY) | (1 << COM_TX_BUSY)));
+}
+
+/** @brief Resolve an LED number within the active block
+ *
+ *  @param _led LED number within `g_led_block`
+ *  @returns Index into the LED buffer. May be out of range.
+ */
+uint16_t led_index(uint8_t _led) {
+  return (g_led_block << 8) | _led;
 }
 
 /** @brief Process the incoming COMM message
@@ -75,24 +209,101 @@ void init_all(void) {
  *    COM_PKT_BUSY
  *      Sets `g_msg_ok_to_send` to 0, blocking sent messages.
  *    COM_PKT_LED_CTRL
+ *      AUTO_REFRESH
+ *        Set auto-refresh period
  *      CHANGE_BLOCK
  *        Update active LED block
  *      COPY
  *        Copy one LED to others
+ *      RECT_FILL
+ *        Set a rectangle of the matrix to one colour
  *      ERASE
  *        Clear all LEDs
+ *      FILL
+ *        Set a range of LEDs to one colour
+ *      GRADIENT
+ *        Blend a range of LEDs between two colours
+ *      FILL_HSV
+ *        Set a range of LEDs to one HSV colour
+ *      SET_BRIGHTNESS
+ *        Set global brightness, then update LEDs
+ *      ANIM
+ *        Start or stop the flash animation, and/or set it to play at power on
+ *      EFFECT
+ *        Start, stop or tune a built-in effect
+ *      LOAD_SCENE
+ *        Recall a saved scene, then update LEDs
+ *      MATRIX
+ *        Set (and save) the matrix geometry
+ *      NUM_LEDS
+ *        Set (and save) the active LED count
+ *      OVERLAY
+ *        Set the overlay of a range of LEDs
  *      PUSH
- *        Update LEDs
+ *        Update LEDs, up to the last one changed since the previous push
+ *      QUEUE
+ *        Commit the staged frame to the jitter queue
+ *      ROTATE
+ *        Rotate a range of LEDs
+ *      SHIFT
+ *        Shift a range of LEDs, filling in behind
+ *      FADE
+ *        Fade to the staged target frame, or a colour
+ *      FRAME_RATE
+ *        Push at a fixed frame rate, or when asked again
+ *      VM
+ *        Start, stop or save the uploaded VM program
+ *      SAVE_SCENE
+ *        Save the LEDs to EEPROM, and/or set the power-on scene
+ *      SCROLL_X
+ *        Scroll a matrix sideways, with optional new columns
+ *      SCROLL_Y
+ *        Scroll a matrix up/down, with optional new rows
  *    COM_PKT_LED_DATA
  *      Write each LED data segment to the correct LED within the block.
  *    COM_PKT_READY
  *      Sets `g_msg_ok_to_send` to 1, allowing sent messages.
+ *    COM_PKT_LED_DATA_RGBW
+ *      Same as COM_PKT_LED_DATA, with a white channel.
+ *    COM_PKT_LED_DATA_16
+ *      Same as COM_PKT_LED_DATA, with 16 bits per channel.
+ *    COM_PKT_PALETTE_DATA
+ *      Write each colour to the correct palette entry.
+ *    COM_PKT_LED_DATA_PAL
+ *      Write palette indices to consecutive LEDs within the block.
+ *    COM_PKT_VM_DATA
+ *      Write part of the VM program.
+ *    COM_PKT_FADE_DATA
+ *      Write each LED data segment to the fade target frame.
+ *    COM_PKT_LED_DATA_XY
+ *      Write each LED data segment to the correct matrix pixel.
+ *    COM_PKT_MATRIX_MAP
+ *      Write part of the custom matrix wiring table.
+ *    COM_PKT_SEGMENT
+ *      Define, set, fill, fade, shift or rotate one segment.
+ *    COM_PKT_OVERLAY_DATA
+ *      Write each LED data segment to the overlay layer, with its alpha.
+ *    COM_PKT_LED_DATA_HSV
+ *      Convert each HSV LED data segment, and write it to the correct LED.
+ *    COM_PKT_LED_DATA_HUE
+ *      Convert hues to consecutive LEDs within the block.
+ *    COM_PKT_QUEUE_DATA
+ *      Write each LED data segment to the frame staged for the jitter queue.
+ *    COM_PKT_QUERY
+ *      Reply with a COM_PKT_STATUS.
+ *
+ *  LED numbers past the active LED count (`rgb_num_leds`) are ignored.
  *  @returns Void.
  */
 void process_incoming_message(void) {
   // Grab received packet
   com_message_t _rec_pkt = com_rec_packet();
 
+  // Anything past the buffer was never stored
+  if (_rec_pkt.length > COM_MAX_DATA_LENGTH) {
+    _rec_pkt.length = COM_MAX_DATA_LENGTH;
+  }
+
   // Process packet.
   switch (_rec_pkt.type) {
     // Ensure we don't send any more packets
@@ -103,52 +314,734 @@ void process_incoming_message(void) {
     case COM_PKT_LED_CTRL: {
       // TODO: Support ALL the commands
       switch (_rec_pkt.data[0]) {
+        // AUTO_REFRESH ('A')
+        case 0x41: {
+          tsk_cancel(g_refresh_task);
+          g_refresh_task = TSK_NONE;
+          if (_rec_pkt.data[1]) {
+            g_refresh_task = tsk_add(refresh_task, _rec_pkt.data[1],
+                                     _rec_pkt.data[1], millis());
+          }
+        } break;
         // CHANGE_BLOCK ('B')
         case 0x42: {
           g_led_block = _rec_pkt.data[1];
         } break;
         // COPY ('C')
         case 0x43: {
-          uint16_t _cpy_idx = g_led_block & _rec_pkt.data[1];
+          uint16_t _cpy_idx = led_index(_rec_pkt.data[1]);
+          if (_cpy_idx >= rgb_num_leds) {
+            break;
+          }
           for (uint8_t _led = 2; _led < _rec_pkt.length; _led++) {
-            rgb_led[g_led_block & _rec_pkt.data[_led]] = rgb_led[_cpy_idx];
+            uint16_t _rgb_idx = led_index(_rec_pkt.data[_led]);
+            if (_rgb_idx < rgb_num_leds) {
+              rgb_copy(_rgb_idx, _cpy_idx);
+            }
           }
         } break;
+        // RECT_FILL ('D')
+        case 0x44: {
+#ifdef RGB_MATRIX
+          if (_rec_pkt.length > 7) {
+            mtx_fill_rect(_rec_pkt.data[1], _rec_pkt.data[2],
+                          _rec_pkt.data[3], _rec_pkt.data[4],
+                          (rgb_t){
+                            .red = _rec_pkt.data[5],
+                            .green = _rec_pkt.data[6],
+                            .blue = _rec_pkt.data[7],
+                          });
+          }
+#endif /* RGB_MATRIX */
+        } break;
         // ERASE ('E')
         case 0x45: {
           rgb_clear();
         } break;
+        // FILL ('F')
+        case 0x46: {
+          if (_rec_pkt.length > 7) {
+            rgb_fill(((uint16_t)_rec_pkt.data[1] << 8) | _rec_pkt.data[2],
+                     ((uint16_t)_rec_pkt.data[3] << 8) | _rec_pkt.data[4],
+                     (rgb_t){
+                       .red = _rec_pkt.data[5],
+                       .green = _rec_pkt.data[6],
+                       .blue = _rec_pkt.data[7],
+                     });
+          }
+        } break;
+        // GRADIENT ('G')
+        case 0x47: {
+          if (_rec_pkt.length > 10) {
+            rgb_gradient(((uint16_t)_rec_pkt.data[1] << 8) | _rec_pkt.data[2],
+                         ((uint16_t)_rec_pkt.data[3] << 8) | _rec_pkt.data[4],
+                         (rgb_t){
+                           .red = _rec_pkt.data[5],
+                           .green = _rec_pkt.data[6],
+                           .blue = _rec_pkt.data[7],
+                         },
+                         (rgb_t){
+                           .red = _rec_pkt.data[8],
+                           .green = _rec_pkt.data[9],
+                           .blue = _rec_pkt.data[10],
+                         });
+          }
+        } break;
+        // FILL_HSV ('H')
+        case 0x48: {
+          if (_rec_pkt.length > 7) {
+            rgb_fill(((uint16_t)_rec_pkt.data[1] << 8) | _rec_pkt.data[2],
+                     ((uint16_t)_rec_pkt.data[3] << 8) | _rec_pkt.data[4],
+                     clr_hsv((hsv_t){
+                       .hue = _rec_pkt.data[5],
+                       .sat = _rec_pkt.data[6],
+                       .val = _rec_pkt.data[7],
+                     }));
+          }
+        } break;
+        // SET_BRIGHTNESS ('I')
+        case 0x49: {
+          rgb_set_brightness(_rec_pkt.data[1]);
+          push_to_led();
+        } break;
+        // ANIM ('J')
+        case 0x4A: {
+          if (_rec_pkt.data[1]) {
+            efx_stop();
+            vm_stop();
+#ifndef RGB_NO_FADE
+            fad_stop();
+#endif /* RGB_NO_FADE */
+#ifdef RGB_QUEUE
+            que_clear();
+#endif /* RGB_QUEUE */
+            anm_start();
+          } else {
+            anm_stop();
+          }
+          if (_rec_pkt.length > 2) {
+            anm_set_power_on(_rec_pkt.data[2]);
+          }
+        } break;
+        // EFFECT ('K')
+        case 0x4B: {
+          // Parameters are optional - anything not sent is left alone
+          if (_rec_pkt.length > 2) {
+            efx_params.speed = _rec_pkt.data[2];
+          }
+          if (_rec_pkt.length > 3) {
+            efx_params.size = _rec_pkt.data[3];
+          }
+          if (_rec_pkt.length > 6) {
+            efx_params.colour = (rgb_t){
+              .red = _rec_pkt.data[4],
+              .green = _rec_pkt.data[5],
+              .blue = _rec_pkt.data[6],
+            };
+          }
+          vm_stop();
+#ifndef RGB_NO_FADE
+          fad_stop();
+#endif /* RGB_NO_FADE */
+          anm_stop();
+#ifdef RGB_QUEUE
+          que_clear();
+#endif /* RGB_QUEUE */
+          efx_start(_rec_pkt.data[1]);
+        } break;
+        // LOAD_SCENE ('L')
+        case 0x4C: {
+          if (scn_load(_rec_pkt.data[1])) {
+            efx_stop();
+            vm_stop();
+#ifndef RGB_NO_FADE
+            fad_stop();
+#endif /* RGB_NO_FADE */
+            anm_stop();
+#ifdef RGB_QUEUE
+            que_clear();
+#endif /* RGB_QUEUE */
+            push_to_led();
+          }
+        } break;
+        // MATRIX ('M')
+        case 0x4D: {
+#ifdef RGB_MATRIX
+          if (_rec_pkt.length > 3) {
+            mtx_configure(_rec_pkt.data[1], _rec_pkt.data[2],
+                          _rec_pkt.data[3]);
+          }
+#endif /* RGB_MATRIX */
+        } break;
+        // NUM_LEDS ('N')
+        case 0x4E: {
+          rgb_set_num_leds(((uint16_t)_rec_pkt.data[1] << 8)
+                           | _rec_pkt.data[2]);
+        } break;
+        // OVERLAY ('O')
+        case 0x4F: {
+#ifdef RGB_OVERLAY
+          if (_rec_pkt.length > 8) {
+            rgb_fill_overlay(((uint16_t)_rec_pkt.data[1] << 8)
+                             | _rec_pkt.data[2],
+                             ((uint16_t)_rec_pkt.data[3] << 8)
+                             | _rec_pkt.data[4],
+                             (rgb_t){
+                               .red = _rec_pkt.data[5],
+                               .green = _rec_pkt.data[6],
+                               .blue = _rec_pkt.data[7],
+                             },
+                             _rec_pkt.data[8]);
+          }
+#endif /* RGB_OVERLAY */
+        } break;
         // PUSH ('P')
         case 0x50: {
           push_to_led();
         } break;
+        // QUEUE ('Q')
+        case 0x51: {
+#ifdef RGB_QUEUE
+          efx_stop();
+          vm_stop();
+#ifndef RGB_NO_FADE
+          fad_stop();
+#endif /* RGB_NO_FADE */
+          anm_stop();
+          que_commit(((uint16_t)_rec_pkt.data[1] << 8) | _rec_pkt.data[2],
+                     millis());
+#endif /* RGB_QUEUE */
+        } break;
+        // ROTATE ('R')
+        case 0x52: {
+          if (_rec_pkt.length > 5) {
+            rgb_rotate(((uint16_t)_rec_pkt.data[1] << 8) | _rec_pkt.data[2],
+                       ((uint16_t)_rec_pkt.data[3] << 8) | _rec_pkt.data[4],
+                       (int8_t)_rec_pkt.data[5]);
+          }
+        } break;
+        // SHIFT ('S')
+        case 0x53: {
+          if (_rec_pkt.length > 8) {
+            rgb_shift(((uint16_t)_rec_pkt.data[1] << 8) | _rec_pkt.data[2],
+                      ((uint16_t)_rec_pkt.data[3] << 8) | _rec_pkt.data[4],
+                      (int8_t)_rec_pkt.data[5],
+                      (rgb_t){
+                        .red = _rec_pkt.data[6],
+                        .green = _rec_pkt.data[7],
+                        .blue = _rec_pkt.data[8],
+                      });
+          }
+        } break;
+        // FADE ('T')
+        case 0x54: {
+#ifndef RGB_NO_FADE
+          if (_rec_pkt.length > 5) {
+            fad_set_target((rgb_t){
+              .red = _rec_pkt.data[3],
+              .green = _rec_pkt.data[4],
+              .blue = _rec_pkt.data[5],
+            });
+          }
+          efx_stop();
+          vm_stop();
+          anm_stop();
+#ifdef RGB_QUEUE
+          que_clear();
+#endif /* RGB_QUEUE */
+          fad_start(((uint16_t)_rec_pkt.data[1] << 8) | _rec_pkt.data[2]);
+#endif /* RGB_NO_FADE */
+        } break;
+        // FRAME_RATE ('U')
+        case 0x55: {
+          frm_set_rate(_rec_pkt.data[1]);
+        } break;
+        // VM ('V')
+        case 0x56: {
+          if (_rec_pkt.data[1] == 0x01) {
+            efx_stop();
+#ifndef RGB_NO_FADE
+            fad_stop();
+#endif /* RGB_NO_FADE */
+            anm_stop();
+#ifdef RGB_QUEUE
+            que_clear();
+#endif /* RGB_QUEUE */
+            vm_start();
+          } else if (_rec_pkt.data[1] == 0x02) {
+            vm_save();
+          } else {
+            vm_stop();
+          }
+        } break;
+        // SAVE_SCENE ('W')
+        case 0x57: {
+          scn_save(_rec_pkt.data[1]);
+          if (_rec_pkt.length > 2) {
+            scn_set_power_on(_rec_pkt.data[2] ? _rec_pkt.data[1] : SCN_NONE);
+          }
+        } break;
+        // SCROLL_X ('X')
+        case 0x58: {
+          if (_rec_pkt.length < 6) {
+            break;
+          }
+          uint8_t _width = _rec_pkt.data[1];
+          int8_t _dx = _rec_pkt.data[2];
+#ifdef RGB_MATRIX
+          if (_width == 0) {
+            _width = mtx_width;
+          }
+#endif /* RGB_MATRIX */
+          rgb_scroll_x(_width, _dx, (rgb_t){
+            .red = _rec_pkt.data[3],
+            .green = _rec_pkt.data[4],
+            .blue = _rec_pkt.data[5],
+          });
+
+          // New columns, row by row, from any payload
+          uint8_t _cols = (_dx < 0) ? -_dx : _dx;
+          uint8_t _first = (_dx < 0) ? _width - _cols : 0;
+          uint8_t _byte = 6;
+          if (_cols > _width) {
+            break;
+          }
+          for (uint16_t _row = 0; _row + _width <= rgb_num_leds;
+               _row += _width) {
+            for (uint8_t _col = _first; _col < _first + _cols; _col++) {
+              if (_byte + 3 > _rec_pkt.length) {
+                break;
+              }
+              rgb_set(_row + _col, (rgb_t){
+                .red = _rec_pkt.data[_byte],
+                .green = _rec_pkt.data[_byte + 1],
+                .blue = _rec_pkt.data[_byte + 2],
+              });
+              _byte += 3;
+            }
+          }
+        } break;
+        // SCROLL_Y ('Y')
+        case 0x59: {
+          if (_rec_pkt.length < 6) {
+            break;
+          }
+          uint8_t _width = _rec_pkt.data[1];
+          int8_t _dy = _rec_pkt.data[2];
+#ifdef RGB_MATRIX
+          if (_width == 0) {
+            _width = mtx_width;
+          }
+#endif /* RGB_MATRIX */
+          rgb_scroll_y(_width, _dy, (rgb_t){
+            .red = _rec_pkt.data[3],
+            .green = _rec_pkt.data[4],
+            .blue = _rec_pkt.data[5],
+          });
+
+          // New rows, in order, from any payload
+          if (_width == 0) {
+            break;
+          }
+          uint16_t _end = (rgb_num_leds / _width) * _width;
+          uint16_t _led = (_dy < 0) ? _end + _dy * (int16_t)_width : 0;
+          for (uint8_t _byte = 6; _byte + 3 <= _rec_pkt.length;
+               _byte += 3, _led++) {
+            if (_led >= _end) {
+              break;
+            }
+            rgb_set(_led, (rgb_t){
+              .red = _rec_pkt.data[_byte],
+              .green = _rec_pkt.data[_byte + 1],
+              .blue = _rec_pkt.data[_byte + 2],
+            });
+          }
+        } break;
       }
     } break;
     // Set RGB_LED buffer to new data
     case COM_PKT_LED_DATA: {
-      for(uint8_t _led = 0; _led < _rec_pkt.length; _led += 4) {
-        uint16_t _rgb_idx = g_led_block & _rec_pkt.data[_led];
-        rgb_led[_rgb_idx].red = _rec_pkt.data[_led + 1];
-        rgb_led[_rgb_idx].green = _rec_pkt.data[_led + 2];
-        rgb_led[_rgb_idx].blue = _rec_pkt.data[_led + 3];
+      for(uint8_t _led = 0; _led + 4 <= _rec_pkt.length; _led += 4) {
+        uint16_t _rgb_idx = led_index(_rec_pkt.data[_led]);
+        if (_rgb_idx < rgb_num_leds) {
+          rgb_set(_rgb_idx, (rgb_t){
+            .red = _rec_pkt.data[_led + 1],
+            .green = _rec_pkt.data[_led + 2],
+            .blue = _rec_pkt.data[_led + 3],
+          });
+        }
+      }
+    } break;
+    // Set RGB_LED buffer to new data, with white
+    case COM_PKT_LED_DATA_RGBW: {
+      for(uint8_t _led = 0; _led + 5 <= _rec_pkt.length; _led += 5) {
+        uint16_t _rgb_idx = led_index(_rec_pkt.data[_led]);
+        if (_rgb_idx < rgb_num_leds) {
+          rgb_set(_rgb_idx, (rgb_t){
+            .red = _rec_pkt.data[_led + 1],
+            .green = _rec_pkt.data[_led + 2],
+            .blue = _rec_pkt.data[_led + 3],
+#ifdef RGB_WHITE
+            .white = _rec_pkt.data[_led + 4],
+#endif /* RGB_WHITE */
+          });
+        }
+      }
+    } break;
+    // Set RGB_LED buffer to new 16-bit data
+    case COM_PKT_LED_DATA_16: {
+      for(uint8_t _led = 0; _led + 7 <= _rec_pkt.length; _led += 7) {
+        uint16_t _rgb_idx = led_index(_rec_pkt.data[_led]);
+        if (_rgb_idx < rgb_num_leds) {
+          rgb_set(_rgb_idx, (rgb_t){
+            .red = _rec_pkt.data[_led + 1],
+            .green = _rec_pkt.data[_led + 3],
+            .blue = _rec_pkt.data[_led + 5],
+          });
+#ifdef RGB_DITHER
+          rgb_frac[_rgb_idx].red = _rec_pkt.data[_led + 2];
+          rgb_frac[_rgb_idx].green = _rec_pkt.data[_led + 4];
+          rgb_frac[_rgb_idx].blue = _rec_pkt.data[_led + 6];
+#endif /* RGB_DITHER */
+        }
       }
     } break;
     // Allow us to send more packets
     case COM_PKT_READY: {
       g_msg_ok_to_send = 1;
     } break;
+    // Set palette entries
+    case COM_PKT_PALETTE_DATA: {
+#ifdef RGB_PALETTE_SIZE
+      for(uint8_t _entry = 0; _entry + 4 <= _rec_pkt.length; _entry += 4) {
+        rgb_t *_pal = &rgb_palette[_rec_pkt.data[_entry]
+                                   & (RGB_PALETTE_SIZE - 1)];
+        _pal->red = _rec_pkt.data[_entry + 1];
+        _pal->green = _rec_pkt.data[_entry + 2];
+        _pal->blue = _rec_pkt.data[_entry + 3];
+      }
+      rgb_invalidate();
+#endif /* RGB_PALETTE_SIZE */
+    } break;
+    // Set consecutive LEDs to palette entries
+    case COM_PKT_LED_DATA_PAL: {
+#ifdef RGB_PALETTE_SIZE
+      uint16_t _rgb_idx = led_index(_rec_pkt.data[0]);
+      for (uint8_t _led = 1; _led < _rec_pkt.length; _led++, _rgb_idx++) {
+        if (_rgb_idx < rgb_num_leds) {
+          rgb_set_index(_rgb_idx, _rec_pkt.data[_led]);
+        }
+      }
+#endif /* RGB_PALETTE_SIZE */
+    } break;
+    // Write VM program
+    case COM_PKT_VM_DATA: {
+      if (_rec_pkt.length > 1) {
+        vm_write(_rec_pkt.data[0], &_rec_pkt.data[1], _rec_pkt.length - 1);
+      }
+    } break;
+    // Set RGB_LED buffer by matrix position
+    case COM_PKT_LED_DATA_XY: {
+#ifdef RGB_MATRIX
+      for(uint8_t _led = 0; _led + 5 <= _rec_pkt.length; _led += 5) {
+        uint16_t _rgb_idx = mtx_index(_rec_pkt.data[_led],
+                                      _rec_pkt.data[_led + 1]);
+        if (_rgb_idx < rgb_num_leds) {
+          rgb_set(_rgb_idx, (rgb_t){
+            .red = _rec_pkt.data[_led + 2],
+            .green = _rec_pkt.data[_led + 3],
+            .blue = _rec_pkt.data[_led + 4],
+          });
+        }
+      }
+#endif /* RGB_MATRIX */
+    } break;
+    // Write custom matrix wiring
+    case COM_PKT_MATRIX_MAP: {
+#ifdef RGB_MATRIX
+      if (_rec_pkt.length < 4) {
+        break;
+      }
+      uint16_t _entries[(COM_MAX_DATA_LENGTH - 2) / 2];
+      uint8_t _count = 0;
+      for (uint8_t _byte = 2; _byte + 2 <= _rec_pkt.length; _byte += 2) {
+        _entries[_count++] = ((uint16_t)_rec_pkt.data[_byte] << 8)
+                             | _rec_pkt.data[_byte + 1];
+      }
+      mtx_write_custom(((uint16_t)_rec_pkt.data[0] << 8) | _rec_pkt.data[1],
+                       _entries, _count);
+#endif /* RGB_MATRIX */
+    } break;
+    // Stage fade target
+    case COM_PKT_FADE_DATA: {
+#ifndef RGB_NO_FADE
+      for(uint8_t _led = 0; _led + 4 <= _rec_pkt.length; _led += 4) {
+        uint16_t _rgb_idx = led_index(_rec_pkt.data[_led]);
+        if (_rgb_idx < rgb_num_leds) {
+          fad_target[_rgb_idx] = (rgb_t){
+            .red = _rec_pkt.data[_led + 1],
+            .green = _rec_pkt.data[_led + 2],
+            .blue = _rec_pkt.data[_led + 3],
+          };
+        }
+      }
+#endif /* RGB_NO_FADE */
+    } break;
+    // Operate on a segment
+    case COM_PKT_SEGMENT: {
+      if (_rec_pkt.length < 2) {
+        break;
+      }
+      uint8_t _id = _rec_pkt.data[0];
+      switch (_rec_pkt.data[1]) {
+        // DEFINE ('D')
+        case 0x44: {
+          if (_rec_pkt.length > 6) {
+            seg_define(_id,
+                       ((uint16_t)_rec_pkt.data[2] << 8) | _rec_pkt.data[3],
+                       ((uint16_t)_rec_pkt.data[4] << 8) | _rec_pkt.data[5],
+                       _rec_pkt.data[6]);
+          }
+        } break;
+        // FILL ('F')
+        case 0x46: {
+          if (_rec_pkt.length > 4) {
+            seg_fill(_id, (rgb_t){
+              .red = _rec_pkt.data[2],
+              .green = _rec_pkt.data[3],
+              .blue = _rec_pkt.data[4],
+            });
+          }
+        } break;
+        // ROTATE ('R')
+        case 0x52: {
+          if (_rec_pkt.length > 2) {
+            seg_rotate(_id, (int8_t)_rec_pkt.data[2]);
+          }
+        } break;
+        // SHIFT ('S')
+        case 0x53: {
+          if (_rec_pkt.length > 5) {
+            seg_shift(_id, (int8_t)_rec_pkt.data[2], (rgb_t){
+              .red = _rec_pkt.data[3],
+              .green = _rec_pkt.data[4],
+              .blue = _rec_pkt.data[5],
+            });
+          }
+        } break;
+        // FADE ('T')
+        case 0x54: {
+#ifndef RGB_NO_FADE
+          if (_rec_pkt.length < 7) {
+            break;
+          }
+          efx_stop();
+          vm_stop();
+          anm_stop();
+#ifdef RGB_QUEUE
+          que_clear();
+#endif /* RGB_QUEUE */
+          seg_fade(_id, ((uint16_t)_rec_pkt.data[2] << 8) | _rec_pkt.data[3],
+                   (rgb_t){
+                     .red = _rec_pkt.data[4],
+                     .green = _rec_pkt.data[5],
+                     .blue = _rec_pkt.data[6],
+                   });
+#endif /* RGB_NO_FADE */
+        } break;
+        // SET ('W')
+        case 0x57: {
+          uint16_t _pos = ((uint16_t)_rec_pkt.data[2] << 8)
+                          | _rec_pkt.data[3];
+          for (uint8_t _led = 4; _led + 3 <= _rec_pkt.length; _led += 3) {
+            seg_set(_id, _pos++, (rgb_t){
+              .red = _rec_pkt.data[_led],
+              .green = _rec_pkt.data[_led + 1],
+              .blue = _rec_pkt.data[_led + 2],
+            });
+          }
+        } break;
+      }
+    } break;
+    // Set overlay layer
+    case COM_PKT_OVERLAY_DATA: {
+#ifdef RGB_OVERLAY
+      for(uint8_t _led = 0; _led + 5 <= _rec_pkt.length; _led += 5) {
+        uint16_t _rgb_idx = led_index(_rec_pkt.data[_led]);
+        if (_rgb_idx < rgb_num_leds) {
+          rgb_set_overlay(_rgb_idx, (rgb_t){
+            .red = _rec_pkt.data[_led + 1],
+            .green = _rec_pkt.data[_led + 2],
+            .blue = _rec_pkt.data[_led + 3],
+          }, _rec_pkt.data[_led + 4]);
+        }
+      }
+#endif /* RGB_OVERLAY */
+    } break;
+    // Set RGB_LED buffer from HSV data
+    case COM_PKT_LED_DATA_HSV: {
+      for(uint8_t _led = 0; _led + 4 <= _rec_pkt.length; _led += 4) {
+        uint16_t _rgb_idx = led_index(_rec_pkt.data[_led]);
+        if (_rgb_idx < rgb_num_leds) {
+          rgb_set(_rgb_idx, clr_hsv((hsv_t){
+            .hue = _rec_pkt.data[_led + 1],
+            .sat = _rec_pkt.data[_led + 2],
+            .val = _rec_pkt.data[_led + 3],
+          }));
+        }
+      }
+    } break;
+    // Set consecutive LEDs to hues
+    case COM_PKT_LED_DATA_HUE: {
+      uint16_t _rgb_idx = led_index(_rec_pkt.data[2]);
+      hsv_t _hsv = {
+        .sat = _rec_pkt.data[0],
+        .val = _rec_pkt.data[1],
+      };
+      for (uint8_t _led = 3; _led < _rec_pkt.length; _led++, _rgb_idx++) {
+        if (_rgb_idx < rgb_num_leds) {
+          _hsv.hue = _rec_pkt.data[_led];
+          rgb_set(_rgb_idx, clr_hsv(_hsv));
+        }
+      }
+    } break;
+    // Stage jitter queue frame
+    case COM_PKT_QUEUE_DATA: {
+#ifdef RGB_QUEUE
+      for(uint8_t _led = 0; _led + 4 <= _rec_pkt.length; _led += 4) {
+        uint16_t _rgb_idx = led_index(_rec_pkt.data[_led]);
+        if (_rgb_idx < rgb_num_leds) {
+          que_stage[_rgb_idx] = (rgb_t){
+            .red = _rec_pkt.data[_led + 1],
+            .green = _rec_pkt.data[_led + 2],
+            .blue = _rec_pkt.data[_led + 3],
+          };
+        }
+      }
+#endif /* RGB_QUEUE */
+    } break;
+    // Report status
+    case COM_PKT_QUERY: {
+      com_message_t _status = {
+        .type = COM_PKT_STATUS,
+        .length = 1,
+        .data = {_rec_pkt.data[0]},
+      };
+      switch (_rec_pkt.data[0]) {
+#ifdef PRF_ENABLE
+        // PROFILE ('P')
+        case 0x50: {
+          prf_stats_t _stats = prf_stats(_rec_pkt.data[1]);
+          uint32_t _avg = _stats.count ? _stats.total / _stats.count : 0;
+          _status.data[1] = _rec_pkt.data[1];
+          _status.data[2] = _stats.count >> 8;
+          _status.data[3] = _stats.count;
+          for (uint8_t _byte = 0; _byte < 4; _byte++) {
+            uint8_t _shift = 24 - 8 * _byte;
+            _status.data[4 + _byte] = _stats.min >> _shift;
+            _status.data[8 + _byte] = _stats.max >> _shift;
+            _status.data[12 + _byte] = _avg >> _shift;
+          }
+          _status.length = 16;
+          if (_rec_pkt.length > 2 && _rec_pkt.data[2]) {
+            prf_reset(_rec_pkt.data[1]);
+          }
+        } break;
+#endif /* PRF_ENABLE */
+#ifdef RGB_QUEUE
+        // QUEUE ('Q')
+        case 0x51: {
+          _status.data[1] = que_count();
+          _status.data[2] = QUE_DEPTH;
+          _status.data[3] = que_underruns() >> 8;
+          _status.data[4] = que_underruns();
+          _status.data[5] = que_overflows() >> 8;
+          _status.data[6] = que_overflows();
+          _status.length = 7;
+        } break;
+#endif /* RGB_QUEUE */
+        // TASK ('T')
+        case 0x54: {
+          tsk_stats_t _stats = tsk_stats(_rec_pkt.data[1]);
+          _status.data[1] = _rec_pkt.data[1];
+          _status.data[2] = _stats.period >> 8;
+          _status.data[3] = _stats.period;
+          _status.data[4] = _stats.runs >> 8;
+          _status.data[5] = _stats.runs;
+          _status.data[6] = _stats.last_us >> 8;
+          _status.data[7] = _stats.last_us;
+          _status.data[8] = _stats.max_us >> 8;
+          _status.data[9] = _stats.max_us;
+          _status.data[10] = _stats.late_ms >> 8;
+          _status.data[11] = _stats.late_ms;
+          _status.length = 12;
+        } break;
+        // FRAME_RATE ('U')
+        case 0x55: {
+          frm_stats_t _stats = frm_stats();
+          _status.data[1] = _stats.fps;
+          _status.data[2] = _stats.shown;
+          _status.data[3] = _stats.push_us >> 8;
+          _status.data[4] = _stats.push_us;
+          _status.data[5] = _stats.late >> 8;
+          _status.data[6] = _stats.late;
+          _status.data[7] = _stats.missed >> 8;
+          _status.data[8] = _stats.missed;
+          _status.length = 9;
+        } break;
+        // SLEEP ('Z')
+        case 0x5A: {
+          evt_stats_t _stats = evt_stats();
+          _status.data[1] = _stats.sleeps >> 8;
+          _status.data[2] = _stats.sleeps;
+          _status.data[3] = _stats.wake_us;
+          _status.data[4] = _stats.max_us;
+          _status.length = 5;
+        } break;
+      }
+      // Don't drop the reply if a COM_PKT_READY is still going out
+      com_flush();
+      com_send_packet(_status);
+    } break;
+  }
+}
+
+/** @brief Push a frame drawn on the device
+ *
+ *  When a frame rate is set, the push is left to the next due frame.
+ *
+ *  @returns Void.
+ */
+void push_frame(void) {
+  if (!frm_active()) {
+    PRF_BEGIN(PRF_PUSH);
+    rgb_push();
+    PRF_END(PRF_PUSH);
   }
 }
 
 /** @brief Push new data to LED strip, inform the rest of the world
  *
- *  Send a COM_PKT_BUSY, push to LEDs & latch, then send a COM_PKT_READY.
+ *  Send a COM_PKT_BUSY, push to LEDs & latch, then send a COM_PKT_READY. The
+ *  software UART can't survive `rgb_push()` disabling interrupts, so the
+ *  COM_PKT_BUSY is flushed out first when it is in use.
+ *
+ *  When a frame rate is set, nothing is sent or pushed - the LEDs go out
+ *  with the next due frame.
  *
  *  @returns Void.
  */
 void push_to_led(void) {
+  if (frm_active()) {
+    return;
+  }
   com_send_packet(BUSY_MSG);
+#ifdef COM_SOFT_UART
+  com_flush();
+#endif /* COM_SOFT_UART */
+  PRF_BEGIN(PRF_PUSH);
   rgb_push();
+  PRF_END(PRF_PUSH);
   _delay_us(5);
   com_send_packet(READY_MSG);
 }
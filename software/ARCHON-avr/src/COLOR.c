@@ -0,0 +1,48 @@
+/** @file COLOR.c
+ *  @brief Fixed-point colour space conversion
+ *
+ *  This contains the implementation for the interface described in `COLOR.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "COLOR.h"
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+rgb_t clr_hsv(hsv_t _hsv) {
+  // Six sectors of ~43 hues - sector in the high byte, position in the low
+  uint16_t _hue6 = (uint16_t)_hsv.hue * 6;
+  uint8_t _sector = _hue6 >> 8;
+  uint8_t _frac = _hue6;
+
+  // Value, falling edge, rising edge and floor of the sector
+  uint8_t _v = _hsv.val;
+  uint8_t _q = mth_scale8(_v, 255 - mth_scale8(_hsv.sat, _frac));
+  uint8_t _t = mth_scale8(_v, 255 - mth_scale8(_hsv.sat, 255 - _frac));
+  uint8_t _p = mth_scale8(_v, 255 - _hsv.sat);
+
+  switch (_sector) {
+    case 0: {
+      return (rgb_t){.red = _v, .green = _t, .blue = _p};
+    }
+    case 1: {
+      return (rgb_t){.red = _q, .green = _v, .blue = _p};
+    }
+    case 2: {
+      return (rgb_t){.red = _p, .green = _v, .blue = _t};
+    }
+    case 3: {
+      return (rgb_t){.red = _p, .green = _q, .blue = _v};
+    }
+    case 4: {
+      return (rgb_t){.red = _t, .green = _p, .blue = _v};
+    }
+    default: {
+      return (rgb_t){.red = _v, .green = _p, .blue = _q};
+    }
+  }
+}
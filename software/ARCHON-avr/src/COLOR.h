@@ -0,0 +1,48 @@
+/** @file COLOR.h
+ *  @brief Fixed-point colour space conversion
+ *
+ *  HSV to RGB in 8-bit fixed point, for hosts (and effects) that think in
+ *  hue. Every channel of `hsv_t` is 0-255: hue goes once round the colour
+ *  wheel (0 red, 85 green, 170 blue), saturation from white to full colour,
+ *  and value from black to full brightness.
+ *
+ *  The conversion is the usual six-sector one, done with `mth_scale8()`
+ *  only - no division, no floats. See `bench/` for cycles per pixel.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef COLOR_H
+#define COLOR_H
+
+#include <stdint.h>
+
+#include "MATH8.h"
+#include "RGB_LED.h"
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+typedef struct hsv_ {
+  uint8_t hue;
+  uint8_t sat;
+  uint8_t val;
+} hsv_t;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Convert a colour from HSV to RGB
+ *
+ *  Full value and saturation give exactly 255/0 channels. White is 0 on
+ *  RGB_WHITE builds.
+ *
+ *  @param _hsv Colour to convert
+ *  @returns The same colour, in RGB
+ */
+rgb_t clr_hsv(hsv_t _hsv);
+
+
+#endif /* COLOR_H */
@@ -10,6 +10,9 @@
 
 #include "COMM.h"
 
+#include "EVENT.h"
+#include "PROFILE.h"
+
 /* -- VARIABLES -- */
 
 volatile uint8_t com_status = (1 << COM_TX_READY);
@@ -18,6 +21,14 @@ volatile com_error_t com_tx_error = COM_NO_ERROR;
 
 /* -- PUBLIC FUNCTIONS -- */
 
+void com_init(uint16_t _baud) {
+  COM_HW_INIT(_baud);
+}
+
+void com_flush(void) {
+  while (!(com_status & (1 << COM_TX_READY))) { }
+}
+
 void com_send_packet(com_message_t _message) {
   if (com_status & (1 << COM_TX_READY)) {
     com_tx_buffer = _message;
@@ -103,6 +114,7 @@ static void com_send_state_machine(void) {
       // Tell the world we're done
       com_status &= ~(1 << COM_TX_BUSY);
       com_status |= (1 << COM_TX_READY);
+      evt_post(EVT_COMM);
 
       com_tx_buffer.state = COM_DONE;
     } break;
@@ -159,6 +171,7 @@ static void com_rec_state_machine(void) {
 
       com_status &= ~(1 << COM_RX_BUSY);
       com_status |= (1 << COM_RX_READY);
+      evt_post(EVT_COMM);
 
       com_rx_buffer.state = COM_DONE;
     } break;
@@ -187,6 +200,8 @@ static uint8_t com_calc_checksum(volatile com_message_t *_message) {
 /* -- ISRS -- */
 
 COM_RX_INTERRUPT() {
+  PRF_BEGIN(PRF_ISR_RX);
+
   // If we were receiving a message, keep going
   if (com_status & (1 << COM_RX_BUSY)) {
     com_rec_state_machine();
@@ -200,6 +215,8 @@ COM_RX_INTERRUPT() {
       com_rec_state_machine();
     }
   }
+
+  PRF_END(PRF_ISR_RX);
 }
 
 COM_TX_INTERRUPT() {
@@ -18,16 +18,30 @@
 #include <avr/interrupt.h>
 #include <stdint.h>
 
-#include "UART.h"
 
 
 /*** CONFIGURATION ***/
 
 #define COM_MAX_DATA_LENGTH 16
-#define COM_RECV()          urt_recv()
-#define COM_SEND(_byte)     urt_send(_byte)
-#define COM_RX_INTERRUPT()  ISR(USART_RX_vect)
-#define COM_TX_INTERRUPT()  ISR(USART_TX_vect)
+
+// COM_SOFT_UART moves COMM off of USART0 (e.g. for RGB_DUAL_CHAIN builds).
+#ifdef COM_SOFT_UART
+  #include "SOFT_UART.h"
+
+  #define COM_HW_INIT(_baud)  swu_init(_baud)
+  #define COM_RECV()          swu_recv()
+  #define COM_SEND(_byte)     swu_send(_byte)
+  #define COM_RX_INTERRUPT()  void swu_rx_complete(void)
+  #define COM_TX_INTERRUPT()  void swu_tx_complete(void)
+#else
+  #include "UART.h"
+
+  #define COM_HW_INIT(_baud)  urt_init(_baud)
+  #define COM_RECV()          urt_recv()
+  #define COM_SEND(_byte)     urt_send(_byte)
+  #define COM_RX_INTERRUPT()  ISR(USART_RX_vect)
+  #define COM_TX_INTERRUPT()  ISR(USART_TX_vect)
+#endif /* COM_SOFT_UART */
 
 
 /*** VARIABLES & DEFINITIONS ***/
@@ -69,17 +83,174 @@ typedef enum com_state {
  *    COM_PKT_LED_CTRL
  *      Execute one of various LED commands, specified by the first data byte.
  *      Supported commands are:
+ *        AUTO_REFRESH <0x41>
+ *          Push the buffers every N milliseconds without being asked, so
+ *          dithering keeps running. Second byte specifies N (1-255), 0
+ *          disables. No COM_PKT_BUSY/COM_PKT_READY are sent for these pushes,
+ *          and they wait for any incoming packet to finish.
  *        CHANGE_BLOCK <0x42>
  *          Change which 8-bit block the LED_DATA packet writes to. Second byte
  *          specifies the new block to write to.
  *        COPY <0x43>
  *          Copy the value of one LED to multiple other LEDs. Second byte
  *          specifies the parent LED, all other bytes specify child LEDs.
+ *        RECT_FILL <0x44>
+ *          Set a rectangle of the matrix (RGB_MATRIX builds only) to one
+ *          colour. The format is:
+ *          ```
+ *          <0x44><X><Y><WIDTH><HEIGHT><R_VAL><G_VAL><B_VAL>
+ *          ```
+ *          Clipped to the matrix.
  *        ERASE <0x45>
  *          Sets all LEDs within the block to 0. No additional parameters.
+ *        FILL <0x46>
+ *          Set a range of LEDs to one colour. The format is:
+ *          ```
+ *          <0x46><START_HI><START_LO><COUNT_HI><COUNT_LO><R_VAL><G_VAL><B_VAL>
+ *          ```
+ *          START is an absolute LED number (CHANGE_BLOCK doesn't apply). LEDs
+ *          past the active LED count are skipped.
+ *        GRADIENT <0x47>
+ *          Blend a range of LEDs from one colour to another. The format is:
+ *          ```
+ *          <0x47><START_HI><START_LO><COUNT_HI><COUNT_LO><R_A><G_A><B_A>
+ *                <R_B><G_B><B_B>
+ *          ```
+ *          The first LED is set to A, the last to B. Ranges work as in FILL.
+ *        FILL_HSV <0x48>
+ *          Same as FILL, but the colour is given as hue, saturation and value
+ *          (see `COLOR.h`). The format is:
+ *          ```
+ *          <0x48><START_HI><START_LO><COUNT_HI><COUNT_LO><H_VAL><S_VAL><V_VAL>
+ *          ```
+ *        SET_BRIGHTNESS <0x49>
+ *          Set global brightness and push immediately. Second byte specifies
+ *          the brightness (0-255). Buffered LED values are not changed, but
+ *          all LEDs are sent.
+ *        ANIM <0x4A>
+ *          Play the animation compiled into flash (see `ANIM.h`). The format
+ *          is:
+ *          ```
+ *          <0x4A><PLAY><POWER_ON>
+ *          ```
+ *          PLAY is 0 (stop) or 1 (play from the first frame, stopping any
+ *          effect, VM program or fade). POWER_ON is optional - if sent, 1
+ *          plays the animation at every power on, and 0 stops that. Frames
+ *          are pushed like EFFECT frames.
+ *        EFFECT <0x4B>
+ *          Start, stop or tune a built-in effect (see `EFFECT.h`). The format
+ *          is:
+ *          ```
+ *          <0x4B><EFFECT><SPEED><SIZE><R_VAL><G_VAL><B_VAL>
+ *          ```
+ *          EFFECT is 0 (stop), 1 (RAINBOW), 2 (CHASE), 3 (BREATHE),
+ *          4 (TWINKLE) or 5 (FIRE). Everything after EFFECT is optional -
+ *          parameters that aren't sent keep their last value, and sending the
+ *          running effect again only changes its parameters. Frames are
+ *          pushed without COM_PKT_BUSY/COM_PKT_READY, and wait for any
+ *          incoming packet to finish. LED data written while an effect is
+ *          running is drawn over. Starting an effect stops the VM, any fade and
+ *          any animation.
+ *        LOAD_SCENE <0x4C>
+ *          Recall a scene saved with SAVE_SCENE, and push it. Second byte
+ *          specifies the slot (0 to SCN_SLOTS - 1, see `SCENE.h`). Stops any
+ *          effect, VM program, fade or animation. Empty slots are ignored.
+ *        MATRIX <0x4D>
+ *          Set the matrix geometry (RGB_MATRIX builds only), and save it to
+ *          EEPROM. The format is:
+ *          ```
+ *          <0x4D><WIDTH><HEIGHT><LAYOUT>
+ *          ```
+ *          LAYOUT is 0 (rows), 1 (serpentine rows), 2 (columns),
+ *          3 (serpentine columns) or 4 (custom, see COM_PKT_MATRIX_MAP). LED
+ *          data is always addressed row-major, from LED 0 - the layout is
+ *          applied at push time.
+ *        NUM_LEDS <0x4E>
+ *          Set the number of LEDs on the strip, and save it to EEPROM. Second
+ *          and third bytes specify the count (high byte first), clamped to
+ *          1-RGB_NUM_LEDS. LEDs past the new count are not turned off.
+ *          RGB_DUAL_CHAIN builds ignore odd counts.
+ *        OVERLAY <0x4F>
+ *          Set the overlay layer of a range of LEDs (RGB_OVERLAY builds only).
+ *          The format is:
+ *          ```
+ *          <0x4F><START_HI><START_LO><COUNT_HI><COUNT_LO><R_VAL><G_VAL><B_VAL>
+ *                <ALPHA>
+ *          ```
+ *          ALPHA is 0 (transparent, clears the overlay) to 255 (opaque). The
+ *          LEDs underneath are left alone. Ranges work as in FILL.
  *        PUSH <0x50>
  *          Force an immediate update of the RGB LEDs with whatever is in the
- *          buffers. No additional parameters.
+ *          buffers. Only LEDs up to the last one changed since the previous
+ *          push are sent - nothing is sent if none changed. No additional
+ *          parameters.
+ *        QUEUE <0x51>
+ *          Commit the frame staged with COM_PKT_QUEUE_DATA to the jitter
+ *          queue (RGB_QUEUE builds only, see `QUEUE.h`), to be shown T
+ *          milliseconds after the frame committed before it. The format is:
+ *          ```
+ *          <0x51><T_HI><T_LO>
+ *          ```
+ *          Keep the queue a frame or two ahead, and frames are shown evenly
+ *          spaced however unevenly they arrive. Dropped if the queue is full.
+ *          Stops any effect, VM program, fade or animation, and frames are
+ *          pushed like EFFECT frames. Starting any of those, or LOAD_SCENE,
+ *          empties the queue.
+ *        ROTATE <0x52>
+ *          Move a range of LEDs along, wrapping around. The format is:
+ *          ```
+ *          <0x52><START_HI><START_LO><COUNT_HI><COUNT_LO><BY>
+ *          ```
+ *          BY is signed, positive towards the end of the strip. Ranges work
+ *          as in FILL.
+ *        SHIFT <0x53>
+ *          Move a range of LEDs along, filling in behind. The format is:
+ *          ```
+ *          <0x53><START_HI><START_LO><COUNT_HI><COUNT_LO><BY><R><G><B>
+ *          ```
+ *          LEDs moved out of the range are dropped. Otherwise as ROTATE.
+ *        FADE <0x54>
+ *          Fade every LED from its current colour to the target frame, over
+ *          a duration in milliseconds. The format is:
+ *          ```
+ *          <0x54><T_HI><T_LO><R_VAL><G_VAL><B_VAL>
+ *          ```
+ *          The colour is optional - if sent, every LED of the target frame is
+ *          set to it first. Otherwise, the target frame is whatever was
+ *          staged with COM_PKT_FADE_DATA. Stops any effect, VM program or
+ *          animation, and frames are pushed like EFFECT frames.
+ *        FRAME_RATE <0x55>
+ *          Push at a fixed frame rate, timed by TIMER1 (see `FRAME.h`).
+ *          Second byte specifies the frame rate in FPS (1-255), 0
+ *          goes back to pushing when asked. While a frame rate is set, PUSH,
+ *          SET_BRIGHTNESS, LOAD_SCENE, effects and the rest only change the
+ *          buffers, and every due frame pushes whatever changed - without
+ *          COM_PKT_BUSY/COM_PKT_READY, and after any incoming packet.
+ *        VM <0x56>
+ *          Control the uploaded VM program (see `VM.h`). Second byte is 0x00
+ *          (stop), 0x01 (clear registers and run, stopping any effect, fade
+ *          or animation) or 0x02 (save to EEPROM, loaded again at power on).
+ *          Frames are pushed like EFFECT frames.
+ *        SAVE_SCENE <0x57>
+ *          Save the LEDs (and palette) to an EEPROM slot. The format is:
+ *          ```
+ *          <0x57><SLOT><POWER_ON>
+ *          ```
+ *          POWER_ON is optional - if sent, 1 makes SLOT the scene shown at
+ *          power on, and 0 turns the power-on scene off. A SLOT past the
+ *          last (e.g. 0xFF) saves nothing, so only POWER_ON applies.
+ *        SCROLL_X <0x58>
+ *          Scroll a matrix of rows WIDTH LEDs long (from LED 0, row-major)
+ *          sideways by DX columns, filling in behind. The format is:
+ *          ```
+ *          <0x58><WIDTH><DX><R><G><B><R_0><G_0><B_0>...<R_N><G_N><B_N>
+ *          ```
+ *          DX is signed, positive towards the end of each row. Any colours
+ *          after the fill colour are written to the new columns, row by row,
+ *          instead of it. WIDTH 0 uses the MATRIX width.
+ *        SCROLL_Y <0x59>
+ *          Same as SCROLL_X, but scrolls by DY rows. Any colours after the
+ *          fill colour are written to the new rows, in LED order.
  *    COM_PKT_LED_DATA
  *      Update with new RGB LED data, each LED is expressed in 4 bytes. The
  *      format is:
@@ -90,6 +261,190 @@ typedef enum com_state {
  *      Indicates the device sending is ready to recieve - data is ignored.
  *      Packets sent to the device are guaranteed to be processed until device
  *      sends a COM_PKT_BUSY.
+ *    COM_PKT_LED_DATA_RGBW
+ *      Same as COM_PKT_LED_DATA, with a white channel. Each LED is expressed
+ *      in 5 bytes. The format is:
+ *      ```
+ *      <LED_NUM><R_VAL><G_VAL><B_VAL><W_VAL>
+ *      ```
+ *      White is dropped on builds without RGB_WHITE. COM_PKT_LED_DATA sets
+ *      white to 0 on builds with it.
+ *    COM_PKT_LED_DATA_16
+ *      Update with new 16-bit RGB LED data, each LED is expressed in 7 bytes.
+ *      The format is:
+ *      ```
+ *      <LED_NUM><R_HI><R_LO><G_HI><G_LO><B_HI><B_LO>
+ *      ```
+ *      Low bytes are dropped on builds without RGB_DITHER. Other LED data
+ *      packets set the low bytes to 0 on builds with it.
+ *    COM_PKT_PALETTE_DATA
+ *      Update palette entries (RGB_FMT_PAL4/RGB_FMT_PAL8 builds only), each
+ *      entry is expressed in 4 bytes. The format is:
+ *      ```
+ *      <ENTRY><R_VAL><G_VAL><B_VAL>
+ *      ```
+ *    COM_PKT_LED_DATA_PAL
+ *      Set consecutive LEDs to palette entries (RGB_FMT_PAL4/RGB_FMT_PAL8
+ *      builds only), one byte per LED. The format is:
+ *      ```
+ *      <START_LED_NUM><ENTRY_0><ENTRY_1>...<ENTRY_N>
+ *      ```
+ *    COM_PKT_VM_DATA
+ *      Write part of the VM program, and stop the VM. The format is:
+ *      ```
+ *      <OFFSET><BYTE_0><BYTE_1>...<BYTE_N>
+ *      ```
+ *      `tools/vmasm.py` assembles programs into bytes.
+ *    COM_PKT_FADE_DATA
+ *      Same as COM_PKT_LED_DATA, but writes to the FADE target frame. LEDs
+ *      keep showing their current colours until the fade is started.
+ *    COM_PKT_LED_DATA_XY
+ *      Same as COM_PKT_LED_DATA, but LEDs are addressed by matrix column and
+ *      row (RGB_MATRIX builds only). Each LED is expressed in 5 bytes. The
+ *      format is:
+ *      ```
+ *      <X><Y><R_VAL><G_VAL><B_VAL>
+ *      ```
+ *    COM_PKT_MATRIX_MAP
+ *      Write part of the custom matrix wiring table to EEPROM (RGB_MATRIX
+ *      builds only). Each entry is the row-major LED number to send at that
+ *      position on the wire. The format is:
+ *      ```
+ *      <OFFSET_HI><OFFSET_LO><LED_0_HI><LED_0_LO>...<LED_N_HI><LED_N_LO>
+ *      ```
+ *    COM_PKT_SEGMENT
+ *      Operate on one segment of the strip (see `SEGMENT.h`). The first byte
+ *      is the segment ID, the second the command. Supported commands are:
+ *        DEFINE <0x44>
+ *          Set where the segment is, and save it to EEPROM. The format is:
+ *          ```
+ *          <ID><0x44><START_HI><START_LO><LENGTH_HI><LENGTH_LO><FLAGS>
+ *          ```
+ *          FLAGS bit 0 reverses the segment, bit 1 mirrors it about its
+ *          middle. LENGTH 0 undefines it.
+ *        FILL <0x46>
+ *          Set the whole segment to one colour. The format is:
+ *          ```
+ *          <ID><0x46><R_VAL><G_VAL><B_VAL>
+ *          ```
+ *        ROTATE <0x52>
+ *          Move the segment along, wrapping around. The format is:
+ *          ```
+ *          <ID><0x52><BY>
+ *          ```
+ *          BY is signed, positive away from the segment's first position.
+ *        SHIFT <0x53>
+ *          Move the segment along, filling in behind. The format is:
+ *          ```
+ *          <ID><0x53><BY><R><G><B>
+ *          ```
+ *        FADE <0x54>
+ *          Fade the whole segment to one colour. The format is:
+ *          ```
+ *          <ID><0x54><T_HI><T_LO><R_VAL><G_VAL><B_VAL>
+ *          ```
+ *          Works as LED_CTRL FADE, but LEDs outside the segment keep any
+ *          fade they were already in.
+ *        SET <0x57>
+ *          Set consecutive positions of the segment. The format is:
+ *          ```
+ *          <ID><0x57><POS_HI><POS_LO><R_0><G_0><B_0>...<R_N><G_N><B_N>
+ *          ```
+ *          Positions past the end of the segment are ignored.
+ *    COM_PKT_OVERLAY_DATA
+ *      Same as COM_PKT_LED_DATA, but writes to the overlay layer, with an
+ *      opacity (RGB_OVERLAY builds only). Each LED is expressed in 5 bytes.
+ *      The format is:
+ *      ```
+ *      <LED_NUM><R_VAL><G_VAL><B_VAL><ALPHA>
+ *      ```
+ *      The LEDs underneath are left alone, so a highlight can be moved over
+ *      a background without resending it.
+ *    COM_PKT_LED_DATA_HSV
+ *      Same as COM_PKT_LED_DATA, but each colour is given as hue, saturation
+ *      and value (see `COLOR.h`). The format is:
+ *      ```
+ *      <LED_NUM><H_VAL><S_VAL><V_VAL>
+ *      ```
+ *    COM_PKT_LED_DATA_HUE
+ *      Set consecutive LEDs to hues, all with the same saturation and value,
+ *      one byte per LED. The format is:
+ *      ```
+ *      <S_VAL><V_VAL><START_LED_NUM><H_0><H_1>...<H_N>
+ *      ```
+ *    COM_PKT_QUEUE_DATA
+ *      Same as COM_PKT_LED_DATA, but writes to the frame staged for the
+ *      jitter queue (RGB_QUEUE builds only). LEDs not written keep their
+ *      colour from the frame committed before, so only changes need to be
+ *      sent.
+ *    COM_PKT_QUERY
+ *      Ask for a COM_PKT_STATUS reply. First byte specifies what about:
+ *        PROFILE <0x50>
+ *          Cycle counts of one profiled region (PRF_ENABLE builds only, see
+ *          `PROFILE.h`). The format is:
+ *          ```
+ *          <0x50><REGION><RESET>
+ *          ```
+ *          REGION is a `prf_region_t`: 0 (`rgb_push()`), 1 (packet
+ *          handling), 2 (COMM RX ISR), 3 (`millis()` tick ISR) or 4 (paced
+ *          frame ISR). RESET is optional - if sent, 1 clears the region
+ *          after replying.
+ *        QUEUE <0x51>
+ *          Jitter queue depth and counters (RGB_QUEUE builds only).
+ *        TASK <0x54>
+ *          Period, run count and timings of one scheduler task (see
+ *          `TASK.h`). Second byte specifies the task ID.
+ *        FRAME_RATE <0x55>
+ *          Frame rate, push time and missed frame counters.
+ *        SLEEP <0x5A>
+ *          Idle sleep count and wake-up latency.
+ *      Anything else gets a reply with no data after the first byte.
+ *    COM_PKT_STATUS
+ *      Reply to COM_PKT_QUERY, sent by the device. First byte is the one
+ *      queried, then:
+ *        PROFILE <0x50>
+ *          ```
+ *          <0x50><REGION><COUNT_HI><COUNT_LO><MIN_3>...<MIN_0><MAX_3>...<MAX_0>
+ *                <AVG_3>...<AVG_0>
+ *          ```
+ *          COUNT passes through the region, then the shortest, longest and
+ *          average pass [cycles], 4 bytes each, high byte first. Counts
+ *          start over after 65535.
+ *        QUEUE <0x51>
+ *          ```
+ *          <0x51><QUEUED><DEPTH><UNDER_HI><UNDER_LO><OVER_HI><OVER_LO>
+ *          ```
+ *          QUEUED frames are waiting, out of DEPTH. UNDER counts frames
+ *          committed after their time had passed (the queue ran dry), OVER
+ *          frames dropped because it was full. Both wrap at 65535.
+ *        TASK <0x54>
+ *          ```
+ *          <0x54><ID><PERIOD_HI><PERIOD_LO><RUNS_HI><RUNS_LO><LAST_HI>
+ *                <LAST_LO><MAX_HI><MAX_LO><LATE_HI><LATE_LO>
+ *          ```
+ *          PERIOD is 0 for a one-shot task or a free slot [ms]. RUNS wraps at
+ *          65535. LAST and MAX are the last and longest run times [us], LATE
+ *          the most a run started after it was due [ms]. Task 0 draws effect,
+ *          VM, fade, animation and queued frames, and AUTO_REFRESH takes the
+ *          next free ID.
+ *        FRAME_RATE <0x55>
+ *          ```
+ *          <0x55><FPS><SHOWN><PUSH_US_HI><PUSH_US_LO><LATE_HI><LATE_LO>
+ *                <MISSED_HI><MISSED_LO>
+ *          ```
+ *          FPS is the frame rate set (0 if none), SHOWN the frames actually
+ *          pushed over the last second. PUSH_US is the average time a push
+ *          takes [us]. LATE counts frames that had to wait for a packet,
+ *          MISSED frames dropped because the one before was still waiting.
+ *          Both wrap at 65535.
+ *        SLEEP <0x5A>
+ *          ```
+ *          <0x5A><SLEEPS_HI><SLEEPS_LO><WAKE_US><MAX_US>
+ *          ```
+ *          SLEEPS counts the times the main loop ran out of work and slept
+ *          (see `EVENT.h`), and wraps at 65535. WAKE_US and MAX_US are the
+ *          last and longest times from a `millis()` tick back to the main
+ *          loop [us], in steps of EVT_TICK_US.
  *
  *  NOTE: The byte values of com_type are currently left undefined, except for
  *        COM_PKT_EMPTY and COM_PKT_TEST
@@ -101,6 +456,21 @@ typedef enum com_type {
   COM_PKT_LED_CTRL,
   COM_PKT_LED_DATA,
   COM_PKT_READY,
+  COM_PKT_LED_DATA_RGBW,
+  COM_PKT_LED_DATA_16,
+  COM_PKT_PALETTE_DATA,
+  COM_PKT_LED_DATA_PAL,
+  COM_PKT_VM_DATA,
+  COM_PKT_FADE_DATA,
+  COM_PKT_LED_DATA_XY,
+  COM_PKT_MATRIX_MAP,
+  COM_PKT_SEGMENT,
+  COM_PKT_OVERLAY_DATA,
+  COM_PKT_LED_DATA_HSV,
+  COM_PKT_LED_DATA_HUE,
+  COM_PKT_QUEUE_DATA,
+  COM_PKT_QUERY,
+  COM_PKT_STATUS,
 } com_type_t;
 
 // Status Bits
@@ -154,6 +524,24 @@ extern volatile com_error_t com_tx_error;
 
 /* -- PUBLIC FUNCTIONS -- */
 
+/** @brief Initialize the hardware layer used by COMM
+ *
+ *  Calls whatever is configured as `COM_HW_INIT()` in the CONFIGURATION
+ *  section. Interrupts are *not* enabled in this function.
+ *
+ *  @param _baud Baud rate to configure the link for [bps]
+ *  @returns Void.
+ */
+void com_init(uint16_t _baud);
+
+/** @brief Block until the current packet has finished sending
+ *
+ *  Returns immediately if nothing is being sent. Interrupts must be enabled.
+ *
+ *  @returns Void.
+ */
+void com_flush(void);
+
 /** @brief Starts sending a COM packet over UART
  *
  *  Packet is added to internal buffer and state machine is initialized.
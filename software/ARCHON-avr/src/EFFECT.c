@@ -0,0 +1,166 @@
+/** @file EFFECT.c
+ *  @brief Built-in LED animations
+ *
+ *  This contains the implementation for the interface described in
+ *  `EFFECT.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "EFFECT.h"
+
+
+/* -- VARIABLES -- */
+
+efx_params_t efx_params = {
+  .speed = 32,
+  .size = 8,
+  .colour = {.red = 255, .green = 255, .blue = 255},
+};
+
+static efx_effect_t efx_effect = EFX_NONE;
+static uint32_t efx_last;
+
+// EFX_FIRE - temperature of each LED
+static uint8_t efx_heat[RGB_NUM_LEDS];
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void efx_start(efx_effect_t _effect) {
+  if (_effect >= EFX_COUNT) {
+    _effect = EFX_NONE;
+  }
+  if (_effect == efx_effect) {
+    return;
+  }
+
+  efx_effect = _effect;
+  for (uint16_t _led = 0; _led < RGB_NUM_LEDS; _led++) {
+    efx_heat[_led] = 0;
+  }
+  if (efx_effect == EFX_TWINKLE) {
+    rgb_clear();
+  }
+}
+
+void efx_stop(void) {
+  efx_effect = EFX_NONE;
+}
+
+uint8_t efx_update(uint32_t _now) {
+  if (efx_effect == EFX_NONE || (_now - efx_last) < EFX_FRAME_MS) {
+    return 0;
+  }
+  efx_last = _now;
+  efx_render(_now);
+
+  return 1;
+}
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+static rgb_t efx_wheel(uint8_t _hue) {
+  uint8_t _rise = (_hue % 85) * 3;
+  uint8_t _fall = 255 - _rise;
+
+  if (_hue < 85) {
+    return (rgb_t){.red = _fall, .green = _rise};
+  } else if (_hue < 170) {
+    return (rgb_t){.green = _fall, .blue = _rise};
+  } else {
+    return (rgb_t){.red = _rise, .blue = _fall};
+  }
+}
+
+static rgb_t efx_scale(rgb_t _colour, uint8_t _scale) {
+  return (rgb_t){
+    .red = mth_scale8(_colour.red, _scale),
+    .green = mth_scale8(_colour.green, _scale),
+    .blue = mth_scale8(_colour.blue, _scale),
+#ifdef RGB_WHITE
+    .white = mth_scale8(_colour.white, _scale),
+#endif /* RGB_WHITE */
+  };
+}
+
+static void efx_render(uint32_t _now) {
+  // One full cycle every 65536 / speed ms
+  uint32_t _ticks = _now * efx_params.speed;
+  uint8_t _phase = _ticks >> 8;
+
+  switch (efx_effect) {
+    case EFX_RAINBOW: {
+      uint8_t _hue = _phase;
+      for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+        rgb_set(_led, efx_wheel(_hue));
+        _hue += efx_params.size;
+      }
+    } break;
+    case EFX_CHASE: {
+      // 16 steps per cycle
+      uint8_t _size = efx_params.size ? efx_params.size : 1;
+      uint8_t _step = (_ticks >> 12) % _size;
+      for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+        rgb_set(_led, ((_led + _step) % _size) ? (rgb_t){0}
+                                               : efx_params.colour);
+      }
+    } break;
+    case EFX_BREATHE: {
+      // Triangle wave, squared so it lingers near black like the eye expects
+      uint8_t _level = (_phase < 128) ? _phase << 1 : (255 - _phase) << 1;
+      _level = mth_scale8(_level, _level);
+      rgb_t _colour = efx_scale(efx_params.colour, _level);
+      for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+        rgb_set(_led, _colour);
+      }
+    } break;
+    case EFX_TWINKLE: {
+      // Fade faster at higher speeds - never quite 255, which wouldn't fade
+      uint8_t _fade = 254 - (efx_params.speed >> 2);
+      for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+        rgb_set(_led, efx_scale(rgb_get(_led), _fade));
+      }
+      if (mth_random8() < efx_params.size) {
+        uint16_t _led = mth_random16() % rgb_num_leds;
+        rgb_set(_led, efx_params.colour);
+      }
+    } break;
+    case EFX_FIRE: {
+      // Cool every cell a little
+      for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+        uint8_t _cool = mth_random8() % ((efx_params.size >> 2) + 2);
+        efx_heat[_led] = mth_qsub8(efx_heat[_led], _cool);
+      }
+      // Heat drifts up and diffuses
+      for (uint16_t _led = rgb_num_leds - 1; _led >= 2; _led--) {
+        efx_heat[_led] = ((uint16_t)efx_heat[_led - 1]
+                          + efx_heat[_led - 2] + efx_heat[_led - 2]) / 3;
+      }
+      // Randomly ignite new sparks near the bottom
+      if (mth_random8() < 120) {
+        uint8_t _spark = mth_random8()
+                         % ((rgb_num_leds < 7) ? rgb_num_leds : 7);
+        efx_heat[_spark] = mth_qadd8(efx_heat[_spark],
+                                     160 + (mth_random8() % 96));
+      }
+      // Black -> red -> yellow -> white
+      for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+        uint8_t _heat = mth_scale8(efx_heat[_led], 190); // x 191/256
+        uint8_t _ramp = (_heat & 0x3F) << 2;
+        if (_heat & 0x80) {
+          rgb_set(_led, (rgb_t){.red = 255, .green = 255, .blue = _ramp});
+        } else if (_heat & 0x40) {
+          rgb_set(_led, (rgb_t){.red = 255, .green = _ramp});
+        } else {
+          rgb_set(_led, (rgb_t){.red = _ramp});
+        }
+      }
+    } break;
+    default: {
+    } break;
+  }
+}
@@ -0,0 +1,124 @@
+/** @file EFFECT.h
+ *  @brief Built-in LED animations
+ *
+ *  Renders parametrized animations straight into `rgb_led` (through
+ *  `rgb_set()`), so common looks need no link traffic once started. Each
+ *  frame is a pure function of `millis()` (plus some state for TWINKLE and
+ *  FIRE), so animation speed doesn't depend on how often frames are drawn.
+ *
+ *  Supported effects, and what their parameters mean:
+ *  -   EFX_RAINBOW: Colour wheel scrolling along the strip. `size` is the hue
+ *      step between LEDs.
+ *  -   EFX_CHASE: Every `size`th LED lit in `colour`, stepping along the
+ *      strip.
+ *  -   EFX_BREATHE: Whole strip fading in and out of `colour`.
+ *  -   EFX_TWINKLE: Random LEDs flash `colour` and fade out. `size` is the
+ *      chance (out of 256) of a new flash each frame.
+ *  -   EFX_FIRE: Flickering flame from LED 0 upwards. `size` is how quickly
+ *      the flame cools, `colour` is ignored.
+ *  For all of them, `speed` is how quickly the animation moves - one full
+ *  cycle takes 65536 / `speed` milliseconds.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef EFFECT_H
+#define EFFECT_H
+
+#include <stdint.h>
+
+#include "MATH8.h"
+#include "RGB_LED.h"
+
+
+/* -- CONFIGURATION -- */
+
+#define EFX_FRAME_MS 20 // [ms] - 50 FPS
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// SRAM budget, in bytes - FIRE heat map
+#define EFX_SRAM_BYTES RGB_NUM_LEDS
+
+typedef enum efx_effect {
+  EFX_NONE,
+  EFX_RAINBOW,
+  EFX_CHASE,
+  EFX_BREATHE,
+  EFX_TWINKLE,
+  EFX_FIRE,
+  EFX_COUNT,
+} efx_effect_t;
+
+typedef struct efx_params {
+  uint8_t speed;
+  uint8_t size;
+  rgb_t colour;
+} efx_params_t;
+
+// Parameters of the running effect - may be changed at any time
+extern efx_params_t efx_params;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Start an effect
+ *
+ *  Starting the effect that is already running keeps its state, so this can
+ *  be used to change parameters without a jump. Unknown effects stop.
+ *
+ *  @param _effect Effect to run, or EFX_NONE to stop
+ *  @returns Void.
+ */
+void efx_start(efx_effect_t _effect);
+
+/** @brief Stop the running effect
+ *
+ *  LEDs are left as they were in the last frame.
+ *
+ *  @returns Void.
+ */
+void efx_stop(void);
+
+/** @brief Render the next frame, if one is due
+ *
+ *  Call as often as possible. Draws at most one frame every EFX_FRAME_MS.
+ *  Does not push.
+ *
+ *  @param _now Current time, from `millis()` [ms]
+ *  @returns 1 if a frame was drawn (and should be pushed), 0 otherwise
+ */
+uint8_t efx_update(uint32_t _now);
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+/** @brief Colour wheel
+ *
+ *  Red -> green -> blue -> red, at full brightness.
+ *
+ *  @param _hue Position on the wheel
+ *  @returns Colour at `_hue`
+ */
+static rgb_t efx_wheel(uint8_t _hue);
+
+/** @brief Scale a colour
+ *
+ *  @param _colour Colour to scale
+ *  @param _scale Scale factor, 0 (black) to 255 (unchanged)
+ *  @returns Scaled colour
+ */
+static rgb_t efx_scale(rgb_t _colour, uint8_t _scale);
+
+/** @brief Draw one frame of the running effect
+ *
+ *  @param _now Current time [ms]
+ *  @returns Void.
+ */
+static void efx_render(uint32_t _now);
+
+
+#endif /* EFFECT_H */
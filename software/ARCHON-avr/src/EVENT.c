@@ -0,0 +1,62 @@
+/** @file EVENT.c
+ *  @brief Event flags from ISRs, and sleeping until the next one
+ *
+ *  This contains the implementation for the interface described in `EVENT.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "EVENT.h"
+
+
+/* -- VARIABLES -- */
+
+// Everything is worth a look on the first pass
+volatile uint8_t evt_flags = 0xFF;
+
+static evt_stats_t evt_stat = {0};
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+uint8_t evt_take(void) {
+  uint8_t _sreg = SREG;
+  cli();
+  uint8_t _events = evt_flags;
+  evt_flags = 0;
+  SREG = _sreg;
+
+  return _events;
+}
+
+void evt_sleep(void) {
+  cli();
+  if (evt_flags) {
+    sei();
+    return;
+  }
+
+  // `sleep_cpu()` always runs before any interrupt `sei()` lets in
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_enable();
+  sei();
+  sleep_cpu();
+  sleep_disable();
+  evt_stat.sleeps++;
+
+  // Woken by the tick alone, so TCNT0 counts from its compare match
+  uint8_t _ticks = TCNT0;
+  if (evt_flags == (1 << EVT_TICK)) {
+    uint16_t _us = _ticks * EVT_TICK_US;
+    evt_stat.wake_us = (_us > 0xFF) ? 0xFF : _us;
+    if (evt_stat.wake_us > evt_stat.max_us) {
+      evt_stat.max_us = evt_stat.wake_us;
+    }
+  }
+}
+
+evt_stats_t evt_stats(void) {
+  return evt_stat;
+}
@@ -0,0 +1,103 @@
+/** @file EVENT.h
+ *  @brief Event flags from ISRs, and sleeping until the next one
+ *
+ *  Interrupts that give the main loop something to do post an event here:
+ *  COMM when a packet has been received or the link goes idle, TIMER0 on
+ *  every `millis()` tick, and TIMER1 when a paced frame is due. The main
+ *  loop takes the events, handles them, and calls `evt_sleep()` once it has
+ *  nothing left to do - so it sleeps in SLEEP_MODE_IDLE between interrupts
+ *  instead of spinning on `com_status`.
+ *
+ *  Idle mode keeps every clock running, so the UARTs, timers and SPI all
+ *  carry on, and any interrupt wakes the CPU. Waking adds 4 cycles to the
+ *  usual interrupt response (ATmega328P datasheet, 7.1), so ISR latency is
+ *  the same whether the loop was asleep or not - and no longer depends on
+ *  which instruction of the loop it landed on.
+ *
+ *  Wake-up latency is measured on the `millis()` tick: TIMER0 clears on the
+ *  compare match that raises it, so TCNT0 on waking is the time taken to get
+ *  back to the main loop, including the TIMER0 ISR. Only in steps of
+ *  EVT_TICK_US, but enough to show whether anything else held it up.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <stdint.h>
+
+#include "MILLIS_TIMER.h"
+
+
+/* -- CONFIGURATION -- */
+
+// One TIMER0 count [us]
+#define EVT_TICK_US (TMR_MILLIS_PRESCALER / (F_CPU / 1000000UL))
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// Event Bits
+typedef enum evt_bit {
+  EVT_COMM,  // Packet received, or the link went idle
+  EVT_TICK,  // `millis()` moved on
+  EVT_FRAME, // Paced frame due
+} evt_bit_t;
+
+typedef struct evt_stats {
+  uint16_t sleeps;  // Wraps at 65535
+  uint8_t wake_us;  // Last wake-up latency from a tick [us]
+  uint8_t max_us;   // Longest wake-up latency from a tick [us]
+} evt_stats_t;
+
+// Private - use `evt_post()` and `evt_take()`
+extern volatile uint8_t evt_flags;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Post an event for the main loop
+ *
+ *  Only call from ISRs (or with interrupts disabled).
+ *
+ *  @param _event Event to post
+ *  @returns Void.
+ */
+static inline void evt_post(evt_bit_t _event);
+
+/** @brief Take every event posted since the last call
+ *
+ *  @returns Event bits (1 << `evt_bit_t`)
+ */
+uint8_t evt_take(void);
+
+/** @brief Sleep until the next interrupt, unless an event is waiting
+ *
+ *  Checking for events and going to sleep can't be split by an interrupt,
+ *  so an event is never left waiting for the one after it.
+ *
+ *  @returns Void.
+ */
+void evt_sleep(void);
+
+/** @brief Get the sleep count and wake-up latency
+ *
+ *  @returns A snapshot of the statistics
+ */
+evt_stats_t evt_stats(void);
+
+
+/* -- INLINE FUNCTIONS -- */
+
+static inline void evt_post(evt_bit_t _event) {
+  evt_flags |= (1 << _event);
+}
+
+
+#endif /* EVENT_H */
@@ -0,0 +1,82 @@
+/** @file FADE.c
+ *  @brief Timed crossfades between frames
+ *
+ *  This contains the implementation for the interface described in `FADE.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "FADE.h"
+
+#ifndef RGB_NO_FADE
+
+/* -- VARIABLES -- */
+
+rgb_t fad_target[RGB_NUM_LEDS];
+
+static rgb_t fad_from[RGB_NUM_LEDS];
+static uint8_t fad_running = 0;
+static uint8_t fad_started;
+static uint16_t fad_duration;
+static uint32_t fad_start_ms;
+static uint32_t fad_last;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void fad_set_target(rgb_t _colour) {
+  for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+    fad_target[_led] = _colour;
+  }
+}
+
+void fad_start(uint16_t _duration) {
+  for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+    fad_from[_led] = rgb_get(_led);
+  }
+  fad_duration = _duration;
+  fad_started = 0;
+  fad_running = 1;
+}
+
+uint8_t fad_active(void) {
+  return fad_running;
+}
+
+void fad_stop(void) {
+  fad_running = 0;
+}
+
+uint8_t fad_update(uint32_t _now) {
+  if (!fad_running) {
+    return 0;
+  }
+  // Time starts at the first update, so a slow start doesn't skip frames
+  if (!fad_started) {
+    fad_started = 1;
+    fad_start_ms = _now;
+  } else if ((_now - fad_last) < FAD_FRAME_MS) {
+    return 0;
+  }
+  fad_last = _now;
+
+  uint32_t _elapsed = _now - fad_start_ms;
+  if (_elapsed >= fad_duration) {
+    for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+      rgb_set(_led, fad_target[_led]);
+    }
+    fad_running = 0;
+    return 1;
+  }
+
+  uint8_t _amount = (_elapsed << 8) / fad_duration;
+  for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+    rgb_set(_led, rgb_blend(fad_from[_led], fad_target[_led], _amount));
+  }
+
+  return 1;
+}
+
+#endif /* RGB_NO_FADE */
@@ -0,0 +1,89 @@
+/** @file FADE.h
+ *  @brief Timed crossfades between frames
+ *
+ *  Blends every LED from whatever it showed when the fade started to a
+ *  target frame, linearly over a given time. The host only sends the target
+ *  (or a single colour) and the duration - the in-between frames are drawn
+ *  here, from `millis()`, at up to one every FAD_FRAME_MS.
+ *
+ *  The target is staged in `fad_target` (see COM_PKT_FADE_DATA), so it can be
+ *  written over several packets while the LEDs keep showing the old frame.
+ *  Costs 2 `rgb_t` of SRAM per LED - builds with RGB_NO_FADE leave it out.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef FADE_H
+#define FADE_H
+
+#include <stdint.h>
+
+#include "RGB_LED.h"
+
+
+/* -- CONFIGURATION -- */
+
+#define FAD_FRAME_MS 20 // [ms] - 50 FPS
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// Frame to fade to - write before calling `fad_start()`
+extern rgb_t fad_target[RGB_NUM_LEDS];
+
+// SRAM budget, in bytes - target and start frames
+#ifdef RGB_NO_FADE
+  #define FAD_SRAM_BYTES 0
+#else
+  #define FAD_SRAM_BYTES (RGB_NUM_LEDS * RGB_T_BYTES * 2)
+#endif /* RGB_NO_FADE */
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Set every LED of the target frame to one colour
+ *
+ *  Only the active LEDs (`rgb_num_leds`) are set.
+ *
+ *  @param _colour Colour to fade to
+ *  @returns Void.
+ */
+void fad_set_target(rgb_t _colour);
+
+/** @brief Start fading from the current LEDs to `fad_target`
+ *
+ *  A fade that is already running is restarted from wherever it got to.
+ *
+ *  @param _duration Length of the fade [ms]. 0 jumps straight to the target
+ *                   on the next `fad_update()`.
+ *  @returns Void.
+ */
+void fad_start(uint16_t _duration);
+
+/** @brief Check whether a fade is running
+ *
+ *  @returns 1 if a fade is running, 0 otherwise
+ */
+uint8_t fad_active(void);
+
+/** @brief Stop the running fade where it is
+ *
+ *  @returns Void.
+ */
+void fad_stop(void);
+
+/** @brief Draw the next step of the fade, if one is due
+ *
+ *  Call as often as possible. Draws at most one frame every FAD_FRAME_MS,
+ *  and the target frame exactly once the duration is up, then stops. Does
+ *  not push.
+ *
+ *  @param _now Current time, from `millis()` [ms]
+ *  @returns 1 if a frame was drawn (and should be pushed), 0 otherwise
+ */
+uint8_t fad_update(uint32_t _now);
+
+
+#endif /* FADE_H */
@@ -0,0 +1,148 @@
+/** @file FRAME.c
+ *  @brief Fixed frame rate pushes on TIMER1
+ *
+ *  This contains the implementation for the interface described in `FRAME.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "FRAME.h"
+
+#include "EVENT.h"
+#include "PROFILE.h"
+
+
+/* -- VARIABLES -- */
+
+static uint8_t frm_fps = 0;
+static uint32_t frm_period;
+static uint8_t frm_waited = 0;
+static uint16_t frm_push_avg = 0;
+static uint16_t frm_late = 0;
+
+static volatile uint32_t frm_next;
+static volatile uint8_t frm_due = 0;
+static volatile uint8_t frm_ticks = 0;
+static volatile uint8_t frm_count = 0;
+static volatile uint8_t frm_shown = 0;
+static volatile uint16_t frm_missed = 0;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void frm_set_rate(uint8_t _fps) {
+  if (!_fps) {
+    TIMSK1 &= ~(1 << OCIE1A);
+    frm_fps = 0;
+    return;
+  }
+
+  uint8_t _sreg = SREG;
+  cli();
+  frm_fps = _fps;
+  frm_period = TMR_TICKS_PER_S / _fps;
+  frm_due = 0;
+  frm_ticks = 0;
+  frm_count = 0;
+  frm_waited = 0;
+
+  frm_next = tmr_ticks() + frm_period;
+  OCR1A = frm_next;
+  TIFR1 = (1 << OCF1A);
+  TIMSK1 |= (1 << OCIE1A);
+  SREG = _sreg;
+}
+
+uint8_t frm_active(void) {
+  return frm_fps != 0;
+}
+
+uint8_t frm_update(uint8_t _idle) {
+  if (!frm_due) {
+    return 0;
+  }
+  if (!_idle) {
+    if (!frm_waited) {
+      frm_waited = 1;
+      frm_late++;
+    }
+    return 0;
+  }
+  frm_due = 0;
+  frm_waited = 0;
+
+  if (!rgb_dirty) {
+    return 0;
+  }
+
+  PRF_BEGIN(PRF_PUSH);
+  uint32_t _start = micros();
+  rgb_push();
+  uint32_t _us = micros() - _start;
+  PRF_END(PRF_PUSH);
+  if (_us > 0xFFFF) {
+    _us = 0xFFFF;
+  }
+
+  // Moving average over ~8 pushes
+  frm_push_avg = frm_push_avg - (frm_push_avg >> 3) + (_us >> 3);
+
+  uint8_t _sreg = SREG;
+  cli();
+  frm_count++;
+  SREG = _sreg;
+
+  return 1;
+}
+
+frm_stats_t frm_stats(void) {
+  frm_stats_t _stats = {
+    .fps = frm_fps,
+    .push_us = frm_push_avg,
+    .late = frm_late,
+  };
+
+  uint8_t _sreg = SREG;
+  cli();
+  _stats.shown = frm_shown;
+  _stats.missed = frm_missed;
+  SREG = _sreg;
+
+  return _stats;
+}
+
+
+/* -- ISRS -- */
+
+ISR(TIMER1_COMPA_vect) {
+  // Only the low 16 bits matched - not due for another lap of the timer
+  if ((int32_t)(tmr_ticks() - frm_next) < 0) {
+    return;
+  }
+  PRF_BEGIN(PRF_ISR_FRAME);
+  frm_next += frm_period;
+
+  // Interrupts were off for over a frame - skip the frames already gone
+  while ((int32_t)(tmr_ticks() - frm_next) >= 0) {
+    frm_next += frm_period;
+    frm_missed++;
+  }
+  OCR1A = frm_next;
+
+  // The last frame never went out
+  if (frm_due) {
+    frm_missed++;
+  }
+  frm_due = 1;
+  evt_post(EVT_FRAME);
+
+  // One second's worth of frames
+  if (++frm_ticks >= frm_fps) {
+    frm_ticks = 0;
+    frm_shown = frm_count;
+    frm_count = 0;
+  }
+  PRF_END(PRF_ISR_FRAME);
+}
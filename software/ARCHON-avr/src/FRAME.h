@@ -0,0 +1,84 @@
+/** @file FRAME.h
+ *  @brief Fixed frame rate pushes on TIMER1
+ *
+ *  Normally, LEDs are pushed whenever the host (or an effect) asks, so the
+ *  frame rate is whatever the host's timing makes it. With a frame rate
+ *  set, TIMER1 instead marks a frame due every 1/N s, and the LEDs are
+ *  pushed on each due frame if anything changed - writes in between are
+ *  only staged.
+ *
+ *  Frames are timed against the TIMER1 timebase (see `MICROS_TIMER.h`),
+ *  which must be running. Each frame's due time is kept to 32 bits, and
+ *  Compare Match A is set to its low 16 - matches before the upper bits
+ *  agree are ignored, so any rate from 1 FPS up works. The due time moves
+ *  on by exactly one frame period every time, so frames keep their spacing
+ *  even when a push starts late.
+ *
+ *  A frame can't be pushed while a packet is on the wire (see `link_idle()`
+ *  in ARCHON.c). Frames that have to wait for one are counted as late, and
+ *  frames still waiting when the next one is due are dropped and counted as
+ *  missed. The time each push takes is averaged, and the frames actually
+ *  pushed are counted over every second.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <stdint.h>
+
+#include "MICROS_TIMER.h"
+#include "RGB_LED.h"
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+typedef struct frm_stats {
+  uint8_t fps;      // Frame rate set, 0 if not paced [FPS]
+  uint8_t shown;    // Frames pushed in the last full second
+  uint16_t push_us; // Average push time [us]
+  uint16_t late;    // Frames that waited for a packet, wraps at 65535
+  uint16_t missed;  // Frames dropped, wraps at 65535
+} frm_stats_t;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Set the frame rate, and start or stop pacing
+ *
+ *  The counters are kept.
+ *
+ *  @param _fps Frames per second. 0 stops pacing, so pushes happen when
+ *              asked again.
+ *  @returns Void.
+ */
+void frm_set_rate(uint8_t _fps);
+
+/** @brief Check whether pushes are paced
+ *
+ *  @returns 1 if a frame rate is set, 0 otherwise
+ */
+uint8_t frm_active(void);
+
+/** @brief Push the LEDs, if a frame is due and any changed
+ *
+ *  Call as often as possible.
+ *
+ *  @param _idle 1 if nothing is being sent or received, 0 otherwise
+ *  @returns 1 if the LEDs were pushed, 0 otherwise
+ */
+uint8_t frm_update(uint8_t _idle);
+
+/** @brief Get the frame rate and counters
+ *
+ *  @returns A snapshot of the statistics
+ */
+frm_stats_t frm_stats(void);
+
+
+#endif /* FRAME_H */
@@ -0,0 +1,41 @@
+/** @file GAMMA.h
+ *  @brief Per-channel gamma lookup tables.
+ *
+ *  One 256-byte table per colour channel, stored in flash. Tables are
+ *  generated by `tools/gamma.py` (`make gamma`), which also allows per-channel
+ *  maximums for white balancing. Unused tables are dropped at link time.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef GAMMA_H
+#define GAMMA_H
+
+#include <avr/pgmspace.h>
+#include <stdint.h>
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+extern const uint8_t gam_red[256] PROGMEM;
+extern const uint8_t gam_green[256] PROGMEM;
+extern const uint8_t gam_blue[256] PROGMEM;
+extern const uint8_t gam_white[256] PROGMEM;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Look up a gamma-corrected channel value.
+ *
+ *  @param _table One of the `gam_*` tables
+ *  @param _value Linear channel value
+ *  @returns Corrected channel value
+ */
+static inline uint8_t gam_lookup(const uint8_t *_table, uint8_t _value) {
+  return pgm_read_byte(&_table[_value]);
+}
+
+
+#endif /* GAMMA_H */
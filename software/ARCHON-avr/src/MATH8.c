@@ -0,0 +1,17 @@
+/** @file MATH8.c
+ *  @brief Fixed-point colour arithmetic
+ *
+ *  This contains the implementation for the interface described in `MATH8.h`.
+ *  Everything else is inline.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "MATH8.h"
+
+
+/* -- VARIABLES -- */
+
+uint16_t mth_seed = 0xACE1;
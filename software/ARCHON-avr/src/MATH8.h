@@ -0,0 +1,366 @@
+/** @file MATH8.h
+ *  @brief Fixed-point colour arithmetic
+ *
+ *  Small integer kernels shared by everything that scales, blends or fades
+ *  colours (`RGB_LED.h`, `COLOR.h`, `EFFECT.h`...), so each is written and
+ *  checked once. All are inline. On AVR, the ones that lean on the hardware
+ *  multiplier or the carry flag are hand-written in assembly - gcc would
+ *  otherwise do a full 16-bit multiply or add, then compare. The plain C
+ *  versions are kept as `mth_*_ref()`, which every other host builds on, and
+ *  which `make bench` checks the assembly against.
+ *
+ *  Cycle counts are for the AVR assembly alone - the compiler may add a
+ *  `mov` or two around it. `make bench` measures every kernel in place.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef MATH8_H
+#define MATH8_H
+
+#include <stdint.h>
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// Private - state of `mth_random16()`, never 0
+extern uint16_t mth_seed;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Scale an 8-bit value by a fraction
+ *
+ *  6 cycles.
+ *
+ *  @param _value Value to scale
+ *  @param _scale Fraction, (`_scale` + 1) / 256 - so 255 returns `_value`
+ *  @returns `_value * (_scale + 1) / 256`, rounded down
+ */
+static inline uint8_t mth_scale8(uint8_t _value, uint8_t _scale);
+
+/** @brief Scale an 8-bit value by a fraction, never scaling it to 0
+ *
+ *  Keeps dim LEDs lit as brightness goes down. 8 cycles (3 if `_value` is 0).
+ *
+ *  @param _value Value to scale
+ *  @param _scale Fraction, out of 256
+ *  @returns `_value * _scale / 256` rounded down, plus 1 if both are nonzero
+ */
+static inline uint8_t mth_scale8_video(uint8_t _value, uint8_t _scale);
+
+/** @brief Add, saturating at 255
+ *
+ *  3 cycles.
+ *
+ *  @param _a First value
+ *  @param _b Second value
+ *  @returns `_a + _b`, or 255 if that overflows
+ */
+static inline uint8_t mth_qadd8(uint8_t _a, uint8_t _b);
+
+/** @brief Subtract, saturating at 0
+ *
+ *  3 cycles.
+ *
+ *  @param _a Value to subtract from
+ *  @param _b Value to subtract
+ *  @returns `_a - _b`, or 0 if that underflows
+ */
+static inline uint8_t mth_qsub8(uint8_t _a, uint8_t _b);
+
+/** @brief Blend two 8-bit values
+ *
+ *  9 cycles.
+ *
+ *  @param _a Value at `_amount` 0
+ *  @param _b Value approached as `_amount` goes to 255
+ *  @param _amount How far from `_a` to `_b`, out of 256
+ *  @returns `(_a * (256 - _amount) + _b * _amount) / 256`, rounded down
+ */
+static inline uint8_t mth_blend8(uint8_t _a, uint8_t _b, uint8_t _amount);
+
+/** @brief Scale a 16-bit value by a fraction
+ *
+ *  18 cycles.
+ *
+ *  @param _value Value to scale
+ *  @param _scale Fraction, out of 65536
+ *  @returns `_value * _scale / 65536`, rounded down
+ */
+static inline uint16_t mth_scale16(uint16_t _value, uint16_t _scale);
+
+/** @brief Interpolate between two 16-bit values
+ *
+ *  One `mth_scale16()`, plus a compare and an add or subtract (~25 cycles).
+ *
+ *  @param _a Value at `_frac` 0
+ *  @param _b Value approached as `_frac` goes to 65535
+ *  @param _frac How far from `_a` to `_b`, out of 65536
+ *  @returns The value between, rounded towards `_a`
+ */
+static inline uint16_t mth_lerp16(uint16_t _a, uint16_t _b, uint16_t _frac);
+
+/** @brief Get a pseudo-random 16-bit number
+ *
+ *  xorshift16 - repeats every 65535 calls, never returns 0. The shifts by 8
+ *  compile to byte moves, so there is no need for assembly.
+ *
+ *  @returns Next number in the sequence
+ */
+static inline uint16_t mth_random16(void);
+
+/** @brief Get a pseudo-random 8-bit number
+ *
+ *  Low byte of `mth_random16()`, and shares its sequence.
+ *
+ *  @returns Next number in the sequence
+ */
+static inline uint8_t mth_random8(void);
+
+/** @brief C reference for `mth_scale8()`
+ *
+ *  @param _value Value to scale
+ *  @param _scale Fraction, (`_scale` + 1) / 256
+ *  @returns Same as `mth_scale8()`
+ */
+static inline uint8_t mth_scale8_ref(uint8_t _value, uint8_t _scale);
+
+/** @brief C reference for `mth_scale8_video()`
+ *
+ *  @param _value Value to scale
+ *  @param _scale Fraction, out of 256
+ *  @returns Same as `mth_scale8_video()`
+ */
+static inline uint8_t mth_scale8_video_ref(uint8_t _value, uint8_t _scale);
+
+/** @brief C reference for `mth_qadd8()`
+ *
+ *  @param _a First value
+ *  @param _b Second value
+ *  @returns Same as `mth_qadd8()`
+ */
+static inline uint8_t mth_qadd8_ref(uint8_t _a, uint8_t _b);
+
+/** @brief C reference for `mth_qsub8()`
+ *
+ *  @param _a Value to subtract from
+ *  @param _b Value to subtract
+ *  @returns Same as `mth_qsub8()`
+ */
+static inline uint8_t mth_qsub8_ref(uint8_t _a, uint8_t _b);
+
+/** @brief C reference for `mth_blend8()`
+ *
+ *  @param _a Value at `_amount` 0
+ *  @param _b Value approached as `_amount` goes to 255
+ *  @param _amount How far from `_a` to `_b`, out of 256
+ *  @returns Same as `mth_blend8()`
+ */
+static inline uint8_t mth_blend8_ref(uint8_t _a, uint8_t _b, uint8_t _amount);
+
+/** @brief C reference for `mth_scale16()`
+ *
+ *  @param _value Value to scale
+ *  @param _scale Fraction, out of 65536
+ *  @returns Same as `mth_scale16()`
+ */
+static inline uint16_t mth_scale16_ref(uint16_t _value, uint16_t _scale);
+
+/** @brief C reference for `mth_lerp16()`, built on `mth_scale16_ref()`
+ *
+ *  @param _a Value at `_frac` 0
+ *  @param _b Value approached as `_frac` goes to 65535
+ *  @param _frac How far from `_a` to `_b`, out of 65536
+ *  @returns Same as `mth_lerp16()`
+ */
+static inline uint16_t mth_lerp16_ref(uint16_t _a, uint16_t _b,
+                                      uint16_t _frac);
+
+
+/* -- INLINE FUNCTIONS -- */
+
+// NOTE: r1 is gcc's zero register, so anything that uses `mul` clears it
+//       again before returning.
+
+static inline uint8_t mth_scale8(uint8_t _value, uint8_t _scale) {
+#ifdef __AVR__
+  uint8_t _result;
+  asm (
+    "mul  %[value], %[scale]      \n\t"
+    "add  r0, %[value]            \n\t" // + _value, i.e. * (_scale + 1)
+    "mov  %[result], r1           \n\t"
+    "clr  __zero_reg__            \n\t" // Leaves carry alone
+    "adc  %[result], __zero_reg__ \n\t"
+    : [result] "=r" (_result)
+    : [value] "r" (_value), [scale] "r" (_scale)
+    : "r0"
+  );
+  return _result;
+#else
+  return mth_scale8_ref(_value, _scale);
+#endif /* __AVR__ */
+}
+
+static inline uint8_t mth_scale8_video(uint8_t _value, uint8_t _scale) {
+#ifdef __AVR__
+  uint8_t _result = 0;
+  asm (
+    "tst  %[value]                \n\t"
+    "breq 1f                      \n\t"
+    "mul  %[value], %[scale]      \n\t"
+    "mov  %[result], r1           \n\t"
+    "clr  __zero_reg__            \n\t"
+    "cpse %[scale], __zero_reg__  \n\t"
+    "subi %[result], 0xFF         \n\t" // + 1
+    "1:                           \n\t"
+    : [result] "+d" (_result)
+    : [value] "r" (_value), [scale] "r" (_scale)
+    : "r0"
+  );
+  return _result;
+#else
+  return mth_scale8_video_ref(_value, _scale);
+#endif /* __AVR__ */
+}
+
+static inline uint8_t mth_qadd8(uint8_t _a, uint8_t _b) {
+#ifdef __AVR__
+  asm (
+    "add  %[a], %[b]              \n\t"
+    "brcc 1f                      \n\t"
+    "ldi  %[a], 0xFF              \n\t"
+    "1:                           \n\t"
+    : [a] "+d" (_a)
+    : [b] "r" (_b)
+  );
+  return _a;
+#else
+  return mth_qadd8_ref(_a, _b);
+#endif /* __AVR__ */
+}
+
+static inline uint8_t mth_qsub8(uint8_t _a, uint8_t _b) {
+#ifdef __AVR__
+  asm (
+    "sub  %[a], %[b]              \n\t"
+    "brcc 1f                      \n\t"
+    "clr  %[a]                    \n\t"
+    "1:                           \n\t"
+    : [a] "+r" (_a)
+    : [b] "r" (_b)
+  );
+  return _a;
+#else
+  return mth_qsub8_ref(_a, _b);
+#endif /* __AVR__ */
+}
+
+static inline uint8_t mth_blend8(uint8_t _a, uint8_t _b, uint8_t _amount) {
+#ifdef __AVR__
+  uint16_t _sum;
+  asm (
+    "mul  %[b], %[amount]         \n\t"
+    "movw %A[sum], r0             \n\t" // _b * _amount
+    "mul  %[a], %[amount]         \n\t"
+    "sub  %A[sum], r0             \n\t" // - _a * _amount
+    "sbc  %B[sum], r1             \n\t"
+    "add  %B[sum], %[a]           \n\t" // + _a * 256
+    "clr  __zero_reg__            \n\t"
+    : [sum] "=&r" (_sum)
+    : [a] "r" (_a), [b] "r" (_b), [amount] "r" (_amount)
+    : "r0"
+  );
+  return _sum >> 8;
+#else
+  return mth_blend8_ref(_a, _b, _amount);
+#endif /* __AVR__ */
+}
+
+static inline uint16_t mth_scale16(uint16_t _value, uint16_t _scale) {
+#ifdef __AVR__
+  // Only the top 16 bits of the 32-bit product are kept, but the low byte
+  // of the 24-bit middle sum is still needed for its carry
+  uint16_t _result;
+  uint8_t _low;
+  uint8_t _zero;
+  asm (
+    "clr  %[zero]                 \n\t"
+    "mul  %A[value], %A[scale]    \n\t"
+    "mov  %[low], r1              \n\t"
+    "mul  %B[value], %B[scale]    \n\t"
+    "movw %A[result], r0          \n\t"
+    "mul  %B[value], %A[scale]    \n\t"
+    "add  %[low], r0              \n\t"
+    "adc  %A[result], r1          \n\t"
+    "adc  %B[result], %[zero]     \n\t"
+    "mul  %A[value], %B[scale]    \n\t"
+    "add  %[low], r0              \n\t"
+    "adc  %A[result], r1          \n\t"
+    "adc  %B[result], %[zero]     \n\t"
+    "clr  __zero_reg__            \n\t"
+    : [result] "=&r" (_result), [low] "=&r" (_low), [zero] "=&r" (_zero)
+    : [value] "r" (_value), [scale] "r" (_scale)
+    : "r0"
+  );
+  return _result;
+#else
+  return mth_scale16_ref(_value, _scale);
+#endif /* __AVR__ */
+}
+
+static inline uint16_t mth_lerp16(uint16_t _a, uint16_t _b, uint16_t _frac) {
+  if (_b >= _a) {
+    return _a + mth_scale16(_b - _a, _frac);
+  }
+  return _a - mth_scale16(_a - _b, _frac);
+}
+
+static inline uint16_t mth_random16(void) {
+  mth_seed ^= mth_seed << 7;
+  mth_seed ^= mth_seed >> 9;
+  mth_seed ^= mth_seed << 8;
+  return mth_seed;
+}
+
+static inline uint8_t mth_random8(void) {
+  return mth_random16();
+}
+
+static inline uint8_t mth_scale8_ref(uint8_t _value, uint8_t _scale) {
+  return ((uint16_t)_value * (_scale + 1)) >> 8;
+}
+
+static inline uint8_t mth_scale8_video_ref(uint8_t _value, uint8_t _scale) {
+  return (((uint16_t)_value * _scale) >> 8) + (_value && _scale);
+}
+
+static inline uint8_t mth_qadd8_ref(uint8_t _a, uint8_t _b) {
+  uint16_t _sum = (uint16_t)_a + _b;
+  return (_sum > 255) ? 255 : _sum;
+}
+
+static inline uint8_t mth_qsub8_ref(uint8_t _a, uint8_t _b) {
+  return (_a > _b) ? _a - _b : 0;
+}
+
+static inline uint8_t mth_blend8_ref(uint8_t _a, uint8_t _b, uint8_t _amount) {
+  return ((uint16_t)_a * (256 - _amount) + (uint16_t)_b * _amount) >> 8;
+}
+
+static inline uint16_t mth_scale16_ref(uint16_t _value, uint16_t _scale) {
+  return ((uint32_t)_value * _scale) >> 16;
+}
+
+static inline uint16_t mth_lerp16_ref(uint16_t _a, uint16_t _b,
+                                      uint16_t _frac) {
+  if (_b >= _a) {
+    return _a + mth_scale16_ref(_b - _a, _frac);
+  }
+  return _a - mth_scale16_ref(_a - _b, _frac);
+}
+
+
+#endif /* MATH8_H */
@@ -0,0 +1,155 @@
+/** @file MATRIX.c
+ *  @brief 2D matrix geometry & wiring
+ *
+ *  This contains the implementation for the interface described in
+ *  `MATRIX.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "MATRIX.h"
+
+#ifdef RGB_MATRIX
+
+/* -- VARIABLES -- */
+
+uint8_t mtx_width;
+uint8_t mtx_height;
+mtx_layout_t mtx_layout;
+
+static uint8_t EEMEM mtx_width_ee;
+static uint8_t EEMEM mtx_height_ee;
+static uint8_t EEMEM mtx_layout_ee;
+static rgb_map_t EEMEM mtx_custom_ee[RGB_NUM_LEDS];
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void mtx_init(void) {
+  mtx_width = eeprom_read_byte(&mtx_width_ee);
+  mtx_height = eeprom_read_byte(&mtx_height_ee);
+  mtx_layout = eeprom_read_byte(&mtx_layout_ee);
+
+  // Blank EEPROM
+  if (mtx_layout >= MTX_LAYOUT_COUNT || mtx_width == 0 || mtx_height == 0) {
+    mtx_width = (RGB_NUM_LEDS < 255) ? RGB_NUM_LEDS : 255;
+    mtx_height = 1;
+    mtx_layout = MTX_ROWS;
+  }
+
+  mtx_build_map();
+}
+
+void mtx_configure(uint8_t _width, uint8_t _height, mtx_layout_t _layout) {
+  if (_layout >= MTX_LAYOUT_COUNT) {
+    _layout = MTX_ROWS;
+  }
+  mtx_width = _width ? _width : 1;
+  mtx_height = _height ? _height : 1;
+  mtx_layout = _layout;
+
+  eeprom_update_byte(&mtx_width_ee, mtx_width);
+  eeprom_update_byte(&mtx_height_ee, mtx_height);
+  eeprom_update_byte(&mtx_layout_ee, mtx_layout);
+
+  mtx_build_map();
+}
+
+void mtx_write_custom(uint16_t _offset, const uint16_t *_entries,
+                      uint8_t _count) {
+  for (uint8_t _entry = 0; _entry < _count; _entry++) {
+    if (_offset + _entry >= RGB_NUM_LEDS) {
+      break;
+    }
+#if RGB_NUM_LEDS <= 256
+    eeprom_update_byte(&mtx_custom_ee[_offset + _entry], _entries[_entry]);
+#else
+    eeprom_update_word(&mtx_custom_ee[_offset + _entry], _entries[_entry]);
+#endif /* RGB_NUM_LEDS */
+  }
+
+  if (mtx_layout == MTX_CUSTOM) {
+    mtx_build_map();
+  }
+}
+
+uint16_t mtx_index(uint8_t _x, uint8_t _y) {
+  if (_x >= mtx_width || _y >= mtx_height) {
+    return UINT16_MAX;
+  }
+  uint16_t _idx = (uint16_t)_y * mtx_width + _x;
+
+  return (_idx < rgb_num_leds) ? _idx : UINT16_MAX;
+}
+
+void mtx_fill_rect(uint8_t _x, uint8_t _y, uint8_t _width, uint8_t _height,
+                   rgb_t _colour) {
+  if (_x >= mtx_width) {
+    return;
+  }
+  if (_width > mtx_width - _x) {
+    _width = mtx_width - _x;
+  }
+
+  for (uint8_t _row = _y; _row < mtx_height && _row - _y < _height; _row++) {
+    rgb_fill((uint16_t)_row * mtx_width + _x, _width, _colour);
+  }
+}
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+static void mtx_build_map(void) {
+  uint16_t _size = (uint16_t)mtx_width * mtx_height;
+
+  for (uint16_t _pos = 0; _pos < RGB_NUM_LEDS; _pos++) {
+    uint16_t _idx = _pos;
+
+    if (_pos < _size) {
+      uint8_t _x;
+      uint8_t _y;
+
+      switch (mtx_layout) {
+        case MTX_ROWS_SERPENTINE: {
+          _y = _pos / mtx_width;
+          _x = _pos % mtx_width;
+          if (_y & 1) {
+            _x = mtx_width - 1 - _x;
+          }
+          _idx = (uint16_t)_y * mtx_width + _x;
+        } break;
+        case MTX_COLUMNS: {
+          _x = _pos / mtx_height;
+          _y = _pos % mtx_height;
+          _idx = (uint16_t)_y * mtx_width + _x;
+        } break;
+        case MTX_COLUMNS_SERPENTINE: {
+          _x = _pos / mtx_height;
+          _y = _pos % mtx_height;
+          if (_x & 1) {
+            _y = mtx_height - 1 - _y;
+          }
+          _idx = (uint16_t)_y * mtx_width + _x;
+        } break;
+        case MTX_CUSTOM: {
+#if RGB_NUM_LEDS <= 256
+          _idx = eeprom_read_byte(&mtx_custom_ee[_pos]);
+#else
+          _idx = eeprom_read_word(&mtx_custom_ee[_pos]);
+#endif /* RGB_NUM_LEDS */
+        } break;
+        default: {
+        } break;
+      }
+    }
+
+    // Never point outside the buffer, whatever is in EEPROM
+    rgb_map[_pos] = (_idx < RGB_NUM_LEDS) ? _idx : _pos;
+  }
+
+  rgb_invalidate();
+}
+
+#endif /* RGB_MATRIX */
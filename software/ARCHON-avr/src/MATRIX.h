@@ -0,0 +1,120 @@
+/** @file MATRIX.h
+ *  @brief 2D matrix geometry & wiring
+ *
+ *  Only built with RGB_MATRIX. `rgb_led` is always laid out as a row-major
+ *  `mtx_width` x `mtx_height` matrix, from LED 0 - so x,y addressing, and
+ *  SCROLL_X/Y, need no knowledge of how the panel is wired. The wiring is
+ *  handled at push time by `rgb_map`, which this module builds from one of
+ *  the MTX_* layouts:
+ *  -   MTX_ROWS: Rows, every row left to right.
+ *  -   MTX_ROWS_SERPENTINE: Rows, alternating direction (first row left to
+ *      right).
+ *  -   MTX_COLUMNS: Columns, every column top to bottom.
+ *  -   MTX_COLUMNS_SERPENTINE: Columns, alternating direction (first column
+ *      top to bottom).
+ *  -   MTX_CUSTOM: A table uploaded to EEPROM, giving the `rgb_led` index of
+ *      each LED in wire order.
+ *  LEDs on the wire past `mtx_width` x `mtx_height` are sent as-is.
+ *
+ *  The geometry and layout are kept in EEPROM. Costs 1 byte of SRAM per LED
+ *  (2 past 256 LEDs), and as much EEPROM for the custom table.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <avr/eeprom.h>
+#include <stdint.h>
+
+#include "RGB_LED.h"
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+typedef enum mtx_layout {
+  MTX_ROWS,
+  MTX_ROWS_SERPENTINE,
+  MTX_COLUMNS,
+  MTX_COLUMNS_SERPENTINE,
+  MTX_CUSTOM,
+  MTX_LAYOUT_COUNT,
+} mtx_layout_t;
+
+// Current geometry - use `mtx_configure()` to change
+extern uint8_t mtx_width;
+extern uint8_t mtx_height;
+extern mtx_layout_t mtx_layout;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Load the geometry from EEPROM and build `rgb_map`
+ *
+ *  Call after `rgb_init()`. With nothing saved, the matrix is a single row
+ *  of RGB_NUM_LEDS (up to 255) LEDs, in wire order.
+ *
+ *  @returns Void.
+ */
+void mtx_init(void);
+
+/** @brief Set the geometry, save it to EEPROM, and rebuild `rgb_map`
+ *
+ *  Blocks for the EEPROM writes (~3.4ms per changed byte).
+ *
+ *  @param _width LEDs per row
+ *  @param _height Number of rows
+ *  @param _layout How the LEDs are wired. Unknown layouts become MTX_ROWS.
+ *  @returns Void.
+ */
+void mtx_configure(uint8_t _width, uint8_t _height, mtx_layout_t _layout);
+
+/** @brief Write part of the MTX_CUSTOM table to EEPROM
+ *
+ *  Entries past RGB_NUM_LEDS are dropped. `rgb_map` is rebuilt if the
+ *  custom layout is in use. Blocks for the EEPROM writes.
+ *
+ *  @param _offset Wire position of the first entry
+ *  @param _entries `rgb_led` index for each wire position
+ *  @param _count Number of entries
+ *  @returns Void.
+ */
+void mtx_write_custom(uint16_t _offset, const uint16_t *_entries,
+                      uint8_t _count);
+
+/** @brief Get the `rgb_led` index of a pixel
+ *
+ *  @param _x Column, from 0
+ *  @param _y Row, from 0
+ *  @returns LED index, or UINT16_MAX if outside the matrix or strip
+ */
+uint16_t mtx_index(uint8_t _x, uint8_t _y);
+
+/** @brief Set a rectangle of pixels to one colour
+ *
+ *  Clipped to the matrix.
+ *
+ *  @param _x Left column
+ *  @param _y Top row
+ *  @param _width Columns to fill
+ *  @param _height Rows to fill
+ *  @param _colour Colour to write
+ *  @returns Void.
+ */
+void mtx_fill_rect(uint8_t _x, uint8_t _y, uint8_t _width, uint8_t _height,
+                   rgb_t _colour);
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+/** @brief Rebuild `rgb_map` from the current geometry
+ *
+ *  @returns Void.
+ */
+static void mtx_build_map(void);
+
+
+#endif /* MATRIX_H */
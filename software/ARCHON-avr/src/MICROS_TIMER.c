@@ -0,0 +1,80 @@
+/** @file MICROS_TIMER.c
+ *  @brief AVR microsecond timebase on TIMER1
+ *
+ *  This contains the implementation for the interface described in
+ *  `MICROS_TIMER.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "MICROS_TIMER.h"
+
+/* -- VARIABLES -- */
+
+static volatile uint32_t _overflows = 0;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void tmr_micros_init(void) {
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;
+  TIFR1 = (1 << TOV1);
+  TIMSK1 = (1 << TOIE1);
+}
+
+
+void tmr_micros_start(void) {
+  TCCR1B = (1 << CS11);
+}
+
+
+uint32_t micros(void) {
+  uint32_t _high;
+  uint16_t _count = tmr_read(&_high);
+
+  // 2 ticks per microsecond - shifting the parts separately keeps the wrap
+  return (_high << 15) | (_count >> 1);
+}
+
+
+uint32_t tmr_cycles(void) {
+  return tmr_ticks() * TMR_MICROS_PRESCALER;
+}
+
+
+uint32_t tmr_ticks(void) {
+  uint32_t _high;
+  uint16_t _count = tmr_read(&_high);
+
+  return (_high << 16) | _count;
+}
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+static uint16_t tmr_read(uint32_t *_overflows_out) {
+  uint8_t _sreg = SREG;
+  cli();
+  uint16_t _count = TCNT1;
+  uint32_t _high = _overflows;
+
+  // Overflowed, but the ISR hasn't run - a low count is from after it
+  if ((TIFR1 & (1 << TOV1)) && _count < 0x8000) {
+    _high++;
+  }
+  SREG = _sreg;
+
+  *_overflows_out = _high;
+  return _count;
+}
+
+
+/* -- ISRS -- */
+
+ISR(TIMER1_OVF_vect) {
+  _overflows++;
+}
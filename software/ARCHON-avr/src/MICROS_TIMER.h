@@ -0,0 +1,98 @@
+/** @file MICROS_TIMER.h
+ *  @brief AVR microsecond timebase on TIMER1
+ *
+ *  Runs TIMER1 free at F_CPU / TMR_MICROS_PRESCALER, and extends it to 32
+ *  bits by counting overflows, for timing anything shorter than `millis()`
+ *  can see - a packet handler, an ISR, one LED's push. Read it through
+ *  `micros()`, `tmr_cycles()` or `tmr_ticks()`, which are atomic and
+ *  correct for an overflow that is pending but not yet counted.
+ *
+ *  TIMER1 is never reset or reconfigured once started, so Compare Match A
+ *  and B are left free for scheduling against it (see `FRAME.h`).
+ *
+ *  Resolution is one tick, 0.5 us (8 cycles) at 16 MHz. `micros()` and
+ *  `tmr_cycles()` wrap at 2^32, so differences are correct across a wrap.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef MICROS_TIMER_H
+#define MICROS_TIMER_H
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <stdint.h>
+
+
+/* -- CONFIGURATION -- */
+
+#ifndef F_CPU
+  #define F_CPU 16000000UL
+#endif /* F_CPU */
+
+#define TMR_MICROS_PRESCALER 8
+
+// TIMER1 counts per second
+#define TMR_TICKS_PER_S (F_CPU / TMR_MICROS_PRESCALER)
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Initialize TIMER1 as a free-running timebase
+ *
+ *  Normal mode, with the overflow interrupt counting the upper 16 bits.
+ *
+ *  NOTE: Any previous configuration of TIMER1 will be overwritten.
+ *  WARNING: `micros()` assumes TMR_TICKS_PER_S is 2 MHz (F_CPU 16 MHz).
+ *
+ *  @returns Void.
+ */
+void tmr_micros_init(void);
+
+/** @brief Start the microsecond timer (TIMER1), at a /8 prescaler
+ *
+ *  @returns Void.
+ */
+void tmr_micros_start(void);
+
+/** @brief Retrieve number of microseconds since start
+ *
+ *  NOTE: Will overflow approx. once every 71 minutes.
+ *
+ *  @returns microseconds since start
+ */
+uint32_t micros(void);
+
+/** @brief Retrieve number of CPU cycles since start
+ *
+ *  In steps of TMR_MICROS_PRESCALER cycles. Overflows approx. every 268 s.
+ *
+ *  @returns cycles since start
+ */
+uint32_t tmr_cycles(void);
+
+/** @brief Retrieve number of TIMER1 counts since start
+ *
+ *  The low 16 bits are TCNT1, so this can be compared against OCR1A/B.
+ *
+ *  @returns TIMER1 counts since start
+ */
+uint32_t tmr_ticks(void);
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+/** @brief Read the overflow count and TCNT1 together
+ *
+ *  Counts an overflow that has happened but not been handled yet (e.g. with
+ *  interrupts disabled, or from another ISR). Safe to call from ISRs.
+ *
+ *  @param _overflows_out Set to the number of overflows
+ *  @returns TCNT1
+ */
+static uint16_t tmr_read(uint32_t *_overflows_out);
+
+
+#endif /* MICROS_TIMER_H */
@@ -11,6 +11,9 @@
 
 #include "MILLIS_TIMER.h"
 
+#include "EVENT.h"
+#include "PROFILE.h"
+
 /* -- VARIABLES -- */
 
 static volatile uint32_t _millis = 0;
@@ -52,5 +55,8 @@ void tmr_millis_stop(void) {
 /* -- ISRS -- */
 
 ISR(TIMER0_COMPA_vect) {
+  PRF_BEGIN(PRF_ISR_TICK);
   _millis++;
+  evt_post(EVT_TICK);
+  PRF_END(PRF_ISR_TICK);
 }
@@ -0,0 +1,78 @@
+/** @file PROFILE.c
+ *  @brief Cycle-count profiling of named code regions
+ *
+ *  This contains the implementation for the interface described in
+ *  `PROFILE.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "PROFILE.h"
+
+
+/* -- VARIABLES -- */
+
+static prf_stats_t prf_regions[PRF_REGIONS];
+static uint16_t prf_overhead = 0;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void prf_init(void) {
+  // Time an empty region, the same way `PRF_END()` does
+  uint32_t _start = tmr_cycles();
+  prf_record(PRF_PUSH, tmr_cycles() - _start);
+  prf_overhead = prf_regions[PRF_PUSH].min;
+  prf_reset(PRF_PUSH);
+}
+
+void prf_record(prf_region_t _region, uint32_t _cycles) {
+  if (_region >= PRF_REGIONS) {
+    return;
+  }
+  _cycles = (_cycles > prf_overhead) ? _cycles - prf_overhead : 0;
+
+  uint8_t _sreg = SREG;
+  cli();
+  prf_stats_t *_stats = &prf_regions[_region];
+
+  // Start over rather than let the count wrap under the total
+  if (_stats->count == 0xFFFF) {
+    *_stats = (prf_stats_t){0};
+  }
+  if (!_stats->count || _cycles < _stats->min) {
+    _stats->min = _cycles;
+  }
+  if (_cycles > _stats->max) {
+    _stats->max = _cycles;
+  }
+  _stats->total += _cycles;
+  _stats->count++;
+  SREG = _sreg;
+}
+
+prf_stats_t prf_stats(prf_region_t _region) {
+  if (_region >= PRF_REGIONS) {
+    return (prf_stats_t){0};
+  }
+
+  uint8_t _sreg = SREG;
+  cli();
+  prf_stats_t _stats = prf_regions[_region];
+  SREG = _sreg;
+
+  return _stats;
+}
+
+void prf_reset(prf_region_t _region) {
+  if (_region >= PRF_REGIONS) {
+    return;
+  }
+
+  uint8_t _sreg = SREG;
+  cli();
+  prf_regions[_region] = (prf_stats_t){0};
+  SREG = _sreg;
+}
@@ -0,0 +1,102 @@
+/** @file PROFILE.h
+ *  @brief Cycle-count profiling of named code regions
+ *
+ *  Wrap a region in `PRF_BEGIN()`/`PRF_END()` and every pass through it is
+ *  timed on `tmr_cycles()` (see `MICROS_TIMER.h`), keeping a count and the
+ *  min, max and total cycles per region. Results can be read over COMM
+ *  (COM_PKT_QUERY PROFILE), so regions can be timed in place on real boards,
+ *  under real traffic - unlike `bench/`, which times kernels in isolation.
+ *
+ *  The macros compile to nothing unless PRF_ENABLE is defined, so they can
+ *  stay in the code. With it, each region costs two `tmr_cycles()` reads and
+ *  a `prf_record()`. The part of that inside the region is measured once by
+ *  `prf_init()`, and taken off every result. Results are in steps of
+ *  TMR_MICROS_PRESCALER cycles.
+ *
+ *  Regions are a fixed list (`prf_region_t`), so each costs 14 bytes of SRAM
+ *  and no lookup. `PRF_BEGIN()` declares a variable, so `PRF_END()` must be
+ *  in the same scope, and each region can only be open once per scope.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <stdint.h>
+
+#include "MICROS_TIMER.h"
+
+
+/* -- CONFIGURATION -- */
+
+#ifdef PRF_ENABLE
+  #define PRF_BEGIN(_region) uint32_t _prf_##_region = tmr_cycles()
+  #define PRF_END(_region) prf_record(_region, tmr_cycles() - _prf_##_region)
+#else
+  #define PRF_BEGIN(_region)
+  #define PRF_END(_region)
+#endif /* PRF_ENABLE */
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// Regions
+typedef enum prf_region {
+  PRF_PUSH,      // `rgb_push()`, wherever it is called from the main loop
+  PRF_PACKET,    // `process_incoming_message()`
+  PRF_ISR_RX,    // COMM RX ISR, per byte
+  PRF_ISR_TICK,  // `millis()` tick ISR
+  PRF_ISR_FRAME, // Paced frame ISR, on frames only
+  PRF_REGIONS,
+} prf_region_t;
+
+typedef struct prf_stats {
+  uint16_t count;  // Starts over after 65535, with the rest
+  uint32_t min;    // [cycles]
+  uint32_t max;    // [cycles]
+  uint32_t total;  // [cycles]
+} prf_stats_t;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Measure the cost of profiling itself
+ *
+ *  Call once TIMER1 is running, before anything is profiled.
+ *
+ *  @returns Void.
+ */
+void prf_init(void);
+
+/** @brief Add one pass through a region
+ *
+ *  Use `PRF_END()` rather than calling this directly. Safe to call from
+ *  ISRs.
+ *
+ *  @param _region Region passed through
+ *  @param _cycles Cycles taken, including profiling
+ *  @returns Void.
+ */
+void prf_record(prf_region_t _region, uint32_t _cycles);
+
+/** @brief Get the results for one region
+ *
+ *  @param _region Region to read
+ *  @returns A snapshot of the statistics, all 0 if `_region` is out of range
+ */
+prf_stats_t prf_stats(prf_region_t _region);
+
+/** @brief Clear the results for one region
+ *
+ *  @param _region Region to clear
+ *  @returns Void.
+ */
+void prf_reset(prf_region_t _region);
+
+
+#endif /* PROFILE_H */
@@ -0,0 +1,111 @@
+/** @file QUEUE.c
+ *  @brief Jitter queue of timestamped frames
+ *
+ *  This contains the implementation for the interface described in `QUEUE.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "QUEUE.h"
+
+#ifdef RGB_QUEUE
+
+/* -- VARIABLES -- */
+
+// Ring of queued frames, followed by the staging frame
+static rgb_t que_frames[QUE_DEPTH + 1][RGB_NUM_LEDS];
+static uint32_t que_time[QUE_DEPTH + 1];
+
+rgb_t *que_stage = que_frames[0];
+
+static uint8_t que_head = 0;
+static uint8_t que_queued = 0;
+static uint8_t que_started = 0;
+static uint32_t que_last;
+static uint16_t que_underrun_count = 0;
+static uint16_t que_overflow_count = 0;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+uint8_t que_commit(uint16_t _delay, uint32_t _now) {
+  if (que_queued >= QUE_DEPTH) {
+    que_overflow_count++;
+    return 0;
+  }
+
+  // Keep the spacing the host asked for, unless the queue already ran dry
+  uint32_t _time = que_last + _delay;
+  if (!que_started || (int32_t)(_time - _now) < 0) {
+    if (que_started) {
+      que_underrun_count++;
+    }
+    _time = _now + _delay;
+  }
+  que_started = 1;
+  que_last = _time;
+
+  uint8_t _slot = que_head;
+  for (uint8_t _frame = 0; _frame < que_queued; _frame++) {
+    _slot = que_next(_slot);
+  }
+  que_time[_slot] = _time;
+  que_queued++;
+
+  // Next frame starts from this one
+  que_stage = que_frames[que_next(_slot)];
+  memcpy(que_stage, que_frames[_slot], sizeof(que_frames[0]));
+
+  return 1;
+}
+
+void que_clear(void) {
+  rgb_t *_stage = que_stage;
+
+  que_head = 0;
+  que_queued = 0;
+  que_started = 0;
+
+  // Staging stays at the front, where the next commit expects it
+  que_stage = que_frames[0];
+  if (_stage != que_stage) {
+    memcpy(que_stage, _stage, sizeof(que_frames[0]));
+  }
+}
+
+uint8_t que_count(void) {
+  return que_queued;
+}
+
+uint16_t que_underruns(void) {
+  return que_underrun_count;
+}
+
+uint16_t que_overflows(void) {
+  return que_overflow_count;
+}
+
+uint8_t que_update(uint32_t _now) {
+  if (!que_queued || (int32_t)(_now - que_time[que_head]) < 0) {
+    return 0;
+  }
+
+  for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+    rgb_set(_led, que_frames[que_head][_led]);
+  }
+  que_head = que_next(que_head);
+  que_queued--;
+
+  return 1;
+}
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+static inline uint8_t que_next(uint8_t _slot) {
+  return (_slot >= QUE_DEPTH) ? 0 : _slot + 1;
+}
+
+#endif /* RGB_QUEUE */
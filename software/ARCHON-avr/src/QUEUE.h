@@ -0,0 +1,123 @@
+/** @file QUEUE.h
+ *  @brief Jitter queue of timestamped frames
+ *
+ *  Frames pushed the moment the host asks show every hiccup of the host's
+ *  scheduler as a stutter. Instead, the host can stage frames ahead of time
+ *  (COM_PKT_QUEUE_DATA), and commit each with the time it should be shown
+ *  (LED_CTRL QUEUE). Committed frames wait here, and are copied into the
+ *  LEDs on the first `millis()` tick at or after their time - so as long
+ *  as the queue doesn't run dry, frames come out evenly spaced however
+ *  unevenly they arrived.
+ *
+ *  Frame times are relative: each is shown a given time after the frame
+ *  committed before it. If that time has already passed when the frame is
+ *  committed, the queue had run dry - this is counted as an underrun, and
+ *  the frame is shown that given time after now instead, to build the lead
+ *  back up. Frames committed while the queue is full are not queued, and
+ *  are counted as overflows.
+ *
+ *  The staging frame starts as a copy of the frame last committed, so only
+ *  the LEDs that change need to be sent. Only built with RGB_QUEUE, as it
+ *  costs QUE_DEPTH + 1 `rgb_t` of SRAM per LED.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stdint.h>
+
+#include "RGB_LED.h"
+
+
+/* -- CONFIGURATION -- */
+
+// Frames that can wait to be shown, not counting the one being staged
+#ifndef QUE_DEPTH
+  #define QUE_DEPTH 2
+#endif /* QUE_DEPTH */
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// Frame being staged - write LEDs before calling `que_commit()`
+extern rgb_t *que_stage;
+
+// SRAM budget, in bytes - frame buffers
+#ifdef RGB_QUEUE
+  #define QUE_SRAM_BYTES ((QUE_DEPTH + 1) * RGB_NUM_LEDS * RGB_T_BYTES)
+#else
+  #define QUE_SRAM_BYTES 0
+#endif /* RGB_QUEUE */
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Commit the staging frame to the queue
+ *
+ *  The next staging frame starts as a copy of this one.
+ *
+ *  @param _delay Time to show the frame, after the frame committed before
+ *                it [ms]. Also the lead the queue is refilled to after an
+ *                underrun.
+ *  @param _now Current time, from `millis()` [ms]
+ *  @returns 1 if the frame was queued, 0 if the queue was full
+ */
+uint8_t que_commit(uint16_t _delay, uint32_t _now);
+
+/** @brief Drop every frame waiting to be shown
+ *
+ *  The staging frame is kept. The next frame committed starts a new stream,
+ *  so it isn't counted as an underrun.
+ *
+ *  @returns Void.
+ */
+void que_clear(void);
+
+/** @brief Get the number of frames waiting to be shown
+ *
+ *  @returns Frames queued, 0 to QUE_DEPTH
+ */
+uint8_t que_count(void);
+
+/** @brief Get the number of frames committed after their time had passed
+ *
+ *  Wraps at 65535.
+ *
+ *  @returns Underruns since power on
+ */
+uint16_t que_underruns(void);
+
+/** @brief Get the number of frames committed while the queue was full
+ *
+ *  Wraps at 65535.
+ *
+ *  @returns Overflows since power on
+ */
+uint16_t que_overflows(void);
+
+/** @brief Copy the next frame into the LEDs, if it is due
+ *
+ *  Call as often as possible. Copies at most one frame per call. Does not
+ *  push.
+ *
+ *  @param _now Current time, from `millis()` [ms]
+ *  @returns 1 if a frame was copied (and should be pushed), 0 otherwise
+ */
+uint8_t que_update(uint32_t _now);
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+/** @brief Get the slot after another, wrapping round
+ *
+ *  @param _slot Slot number, 0 to QUE_DEPTH
+ *  @returns The next slot number
+ */
+static inline uint8_t que_next(uint8_t _slot);
+
+
+#endif /* QUEUE_H */
@@ -1,5 +1,5 @@
 /** @file RGB_LED.c
- *  @brief WS2812B LED Controller
+ *  @brief Addressable RGB LED Controller
  *
  *  This contains the implementation for the interface described in
  *  `RGB_LED.h`.
@@ -14,20 +14,304 @@
 
 /* -- VARIABLES -- */
 
-rgb_t rgb_led[RGB_NUM_LEDS];
+rgb_store_t rgb_led[RGB_STORE_SIZE];
+
+#ifdef RGB_PALETTE_SIZE
+rgb_t rgb_palette[RGB_PALETTE_SIZE];
+#endif /* RGB_PALETTE_SIZE */
+
+uint8_t rgb_scale = 255;
+uint16_t rgb_num_leds = RGB_NUM_LEDS;
+uint16_t rgb_dirty = RGB_NUM_LEDS;
+
+static uint16_t EEMEM rgb_num_leds_ee = RGB_NUM_LEDS;
+
+#ifdef RGB_MATRIX
+rgb_map_t rgb_map[RGB_NUM_LEDS];
+#endif /* RGB_MATRIX */
+
+#ifdef RGB_DITHER
+rgb_t rgb_frac[RGB_NUM_LEDS];
+rgb_t rgb_err[RGB_NUM_LEDS];
+#endif /* RGB_DITHER */
+
+#ifdef RGB_OVERLAY
+rgb_t rgb_overlay[RGB_NUM_LEDS];
+uint8_t rgb_alpha[RGB_NUM_LEDS];
+#endif /* RGB_OVERLAY */
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+static void rgb_load_state(void) {
+  uint16_t _count = eeprom_read_word(&rgb_num_leds_ee);
+  if (_count < 1 || _count > RGB_NUM_LEDS) {
+    _count = RGB_NUM_LEDS;
+  }
+#ifdef RGB_DUAL_CHAIN
+  if (_count % 2) {
+    _count = RGB_NUM_LEDS;
+  }
+#endif /* RGB_DUAL_CHAIN */
+  rgb_num_leds = _count;
+  rgb_dirty = _count;
+
+#ifdef RGB_MATRIX
+  // Wire order until `MATRIX.h` says otherwise
+  for (uint16_t _led = 0; _led < RGB_NUM_LEDS; _led++) {
+    rgb_map[_led] = _led;
+  }
+#endif /* RGB_MATRIX */
+}
+
+static uint16_t rgb_clip(uint16_t _start, uint16_t _count) {
+  if (_start >= rgb_num_leds) {
+    return 0;
+  }
+  return (_count > rgb_num_leds - _start) ? rgb_num_leds - _start : _count;
+}
+
+static void rgb_move(uint16_t _dst, uint16_t _src, uint16_t _count) {
+  if (_count == 0) {
+    return;
+  }
+#if RGB_FORMAT == RGB_FMT_PAL4
+  // Nibbles - copy one at a time, away from the overlap
+  if (_dst < _src) {
+    for (uint16_t _led = 0; _led < _count; _led++) {
+      rgb_copy(_dst + _led, _src + _led);
+    }
+  } else {
+    for (uint16_t _led = _count; _led > 0; _led--) {
+      rgb_copy(_dst + _led - 1, _src + _led - 1);
+    }
+  }
+#else
+  memmove(&rgb_led[_dst], &rgb_led[_src], _count * sizeof(rgb_store_t));
+  rgb_touch(_dst + _count - 1);
+#endif /* RGB_FORMAT */
+
+#ifdef RGB_DITHER
+  memmove(&rgb_frac[_dst], &rgb_frac[_src], _count * sizeof(rgb_t));
+#endif /* RGB_DITHER */
+}
+
+static void rgb_reverse(uint16_t _start, uint16_t _count) {
+  if (_count < 2) {
+    return;
+  }
+  uint16_t _lo = _start;
+  uint16_t _hi = _start + _count - 1;
+
+  for (; _lo < _hi; _lo++, _hi--) {
+#if RGB_FORMAT == RGB_FMT_PAL4
+    uint8_t _entry = rgb_get_index(_lo);
+    rgb_set_index(_lo, rgb_get_index(_hi));
+    rgb_set_index(_hi, _entry);
+#else
+    rgb_store_t _swap = rgb_led[_lo];
+    rgb_led[_lo] = rgb_led[_hi];
+    rgb_led[_hi] = _swap;
+#endif /* RGB_FORMAT */
+
+#ifdef RGB_DITHER
+    rgb_t _frac = rgb_frac[_lo];
+    rgb_frac[_lo] = rgb_frac[_hi];
+    rgb_frac[_hi] = _frac;
+#endif /* RGB_DITHER */
+  }
+  rgb_touch(_start + _count - 1);
+}
 
 
 /* -- PUBLIC FUNCTIONS -- */
 
 void rgb_clear(void) {
-  for (uint16_t _led = 0; _led < RGB_NUM_LEDS; _led++) {
-    rgb_led[_led].red = 0;
-    rgb_led[_led].green = 0;
-    rgb_led[_led].blue = 0;
+#if RGB_FORMAT == RGB_FMT_PAL4
+  uint16_t _end = (rgb_num_leds + 1) / 2;
+#else
+  uint16_t _end = rgb_num_leds;
+#endif /* RGB_FORMAT */
+
+  for (uint16_t _led = 0; _led < _end; _led++) {
+    rgb_led[_led] = (rgb_store_t){0};
+#ifdef RGB_DITHER
+    rgb_frac[_led] = (rgb_t){0};
+#endif /* RGB_DITHER */
+  }
+  rgb_invalidate();
+}
+
+void rgb_fill(uint16_t _start, uint16_t _count, rgb_t _colour) {
+  uint16_t _end = _start + rgb_clip(_start, _count);
+
+#ifdef RGB_PALETTE_SIZE
+  uint8_t _entry = rgb_match(_colour);
+  for (uint16_t _led = _start; _led < _end; _led++) {
+    rgb_set_index(_led, _entry);
+  }
+#else
+  for (uint16_t _led = _start; _led < _end; _led++) {
+    rgb_set(_led, _colour);
+  }
+#endif /* RGB_PALETTE_SIZE */
+}
+
+#ifdef RGB_OVERLAY
+void rgb_fill_overlay(uint16_t _start, uint16_t _count, rgb_t _colour,
+                      uint8_t _alpha) {
+  uint16_t _end = _start + rgb_clip(_start, _count);
+
+  for (uint16_t _led = _start; _led < _end; _led++) {
+    rgb_set_overlay(_led, _colour, _alpha);
+  }
+}
+#endif /* RGB_OVERLAY */
+
+void rgb_gradient(uint16_t _start, uint16_t _count, rgb_t _from, rgb_t _to) {
+  uint16_t _end = _start + rgb_clip(_start, _count);
+  if (_end == _start) {
+    return;
+  }
+
+  // 8.8 position along the gradient, stepped with one add per LED
+  uint16_t _step = (_count > 1) ? 0xFFFF / (_count - 1) : 0;
+  uint16_t _pos = 0;
+  for (uint16_t _led = _start; _led < _end; _led++) {
+    rgb_set(_led, rgb_blend(_from, _to, _pos >> 8));
+    _pos += _step;
+  }
+
+  // Blending never quite reaches `_to` - a single LED stays at `_from`
+  if (_count > 1 && _start + _count == _end) {
+    rgb_set(_end - 1, _to);
+  }
+}
+
+void rgb_shift(uint16_t _start, uint16_t _count, int16_t _by, rgb_t _fill) {
+  _count = rgb_clip(_start, _count);
+  uint16_t _dist = (_by < 0) ? -_by : _by;
+
+  if (_dist >= _count) {
+    rgb_fill(_start, _count, _fill);
+  } else if (_by > 0) {
+    rgb_move(_start + _dist, _start, _count - _dist);
+    rgb_fill(_start, _dist, _fill);
+  } else if (_by < 0) {
+    rgb_move(_start, _start + _dist, _count - _dist);
+    rgb_fill(_start + _count - _dist, _dist, _fill);
+  }
+}
+
+void rgb_rotate(uint16_t _start, uint16_t _count, int16_t _by) {
+  _count = rgb_clip(_start, _count);
+  if (_count < 2) {
+    return;
+  }
+
+  // Rotating right by N is reversing the whole range, then both parts
+  int16_t _right = _by % (int16_t)_count;
+  uint16_t _dist = (_right < 0) ? _right + _count : _right;
+  if (_dist == 0) {
+    return;
+  }
+  rgb_reverse(_start, _count);
+  rgb_reverse(_start, _dist);
+  rgb_reverse(_start + _dist, _count - _dist);
+}
+
+void rgb_scroll_x(uint8_t _width, int8_t _dx, rgb_t _fill) {
+  if (_width == 0) {
+    return;
+  }
+  for (uint16_t _row = 0; _row + _width <= rgb_num_leds; _row += _width) {
+    rgb_shift(_row, _width, _dx, _fill);
+  }
+}
+
+void rgb_scroll_y(uint8_t _width, int8_t _dy, rgb_t _fill) {
+  if (_width == 0) {
+    return;
+  }
+  uint16_t _rows = rgb_num_leds / _width;
+  rgb_shift(0, _rows * _width, _dy * (int16_t)_width, _fill);
+}
+
+void rgb_invalidate(void) {
+  rgb_dirty = rgb_num_leds;
+}
+
+void rgb_copy(uint16_t _dst, uint16_t _src) {
+#if RGB_FORMAT == RGB_FMT_PAL4
+  rgb_set_index(_dst, rgb_get_index(_src));
+#else
+  rgb_led[_dst] = rgb_led[_src];
+  rgb_touch(_dst);
+#endif /* RGB_FORMAT */
+
+#ifdef RGB_DITHER
+  rgb_frac[_dst] = rgb_frac[_src];
+#endif /* RGB_DITHER */
+}
+
+#ifdef RGB_PALETTE_SIZE
+uint8_t rgb_match(rgb_t _colour) {
+  uint8_t _best = 0;
+  uint16_t _best_dist = UINT16_MAX;
+
+  for (uint16_t _entry = 0; _entry < RGB_PALETTE_SIZE; _entry++) {
+    rgb_t _pal = rgb_palette[_entry];
+    uint16_t _dist = 0;
+    _dist += (_pal.red > _colour.red) ? _pal.red - _colour.red
+                                      : _colour.red - _pal.red;
+    _dist += (_pal.green > _colour.green) ? _pal.green - _colour.green
+                                          : _colour.green - _pal.green;
+    _dist += (_pal.blue > _colour.blue) ? _pal.blue - _colour.blue
+                                        : _colour.blue - _pal.blue;
+#ifdef RGB_WHITE
+    _dist += (_pal.white > _colour.white) ? _pal.white - _colour.white
+                                          : _colour.white - _pal.white;
+#endif /* RGB_WHITE */
+
+    if (_dist < _best_dist) {
+      _best = _entry;
+      _best_dist = _dist;
+      if (_dist == 0) {
+        break;
+      }
+    }
   }
+
+  return _best;
+}
+#endif /* RGB_PALETTE_SIZE */
+
+void rgb_set_num_leds(uint16_t _count) {
+#ifdef RGB_DUAL_CHAIN
+  // Chain B would otherwise send one LED past the end of the strip
+  if (_count % 2) {
+    return;
+  }
+#endif /* RGB_DUAL_CHAIN */
+  if (_count < 1) {
+    _count = 1;
+  } else if (_count > RGB_NUM_LEDS) {
+    _count = RGB_NUM_LEDS;
+  }
+  rgb_num_leds = _count;
+  eeprom_update_word(&rgb_num_leds_ee, _count);
+  rgb_invalidate();
+}
+
+void rgb_set_brightness(uint8_t _level) {
+  rgb_scale = _level;
+  rgb_invalidate();
 }
 
+#if RGB_DRIVER == RGB_WS2812
 void rgb_init(void) {
+  rgb_load_state();
+
   // Initialize SPI for sending signals
   spi_settings_t _rgb_settings = {
     .bus_mode = SPI_MASTER,
@@ -38,24 +322,105 @@ void rgb_init(void) {
   };
   spi_init(_rgb_settings);
   SPI_DDR &= ~(1 << SPI_MOSI);
+
+#ifdef RGB_DUAL_CHAIN
+  urt_init_mspim(RGB_MSPIM_UBRR);
+#endif /* RGB_DUAL_CHAIN */
 }
 
 void rgb_push(void) {
+  if (!rgb_dirty) {
+    return;
+  }
+#ifdef RGB_MATRIX
+  // Dirty LEDs could be anywhere on the wire
+  rgb_dirty = rgb_num_leds;
+#endif /* RGB_MATRIX */
+  uint16_t _chain = RGB_CHAIN_LEDS;
+  uint16_t _end = (rgb_dirty > _chain) ? _chain : rgb_dirty;
+  rgb_dirty = 0;
+
   // Kill the interrupts
   uint8_t sreg = SREG;
   cli();
-  // Write bits - Green - Red - Blue
-  for (uint16_t led_pos = 0; led_pos < RGB_NUM_LEDS; led_pos++) {
-    for (uint8_t bit_pos = RGB_MAX_BIT_POS; bit_pos != 0; bit_pos >>= 1) {
-      rgb_write_bit(rgb_led[led_pos].green & bit_pos);
-    }
-    for (uint8_t bit_pos = RGB_MAX_BIT_POS; bit_pos != 0; bit_pos >>= 1) {
-      rgb_write_bit(rgb_led[led_pos].red & bit_pos);
-    }
-    for (uint8_t bit_pos = RGB_MAX_BIT_POS; bit_pos != 0; bit_pos >>= 1) {
-      rgb_write_bit(rgb_led[led_pos].blue & bit_pos);
-    }
+  // Write corrected bytes in wire order
+#ifdef RGB_DUAL_CHAIN
+  // Both chains at once - second chain starts halfway through the strip
+  for (uint16_t led_pos = 0; led_pos < _end; led_pos++) {
+    uint16_t _src_a = RGB_SOURCE(led_pos);
+    uint16_t _src_b = RGB_SOURCE(led_pos + _chain);
+    rgb_t _px_a = RGB_PIXEL(_src_a);
+    rgb_t _px_b = RGB_PIXEL(_src_b);
+    rgb_write_bytes(RGB_OUT(_px_a, _src_a, RGB_CHAN_0),
+                    RGB_OUT(_px_b, _src_b, RGB_CHAN_0));
+    rgb_write_bytes(RGB_OUT(_px_a, _src_a, RGB_CHAN_1),
+                    RGB_OUT(_px_b, _src_b, RGB_CHAN_1));
+    rgb_write_bytes(RGB_OUT(_px_a, _src_a, RGB_CHAN_2),
+                    RGB_OUT(_px_b, _src_b, RGB_CHAN_2));
+#ifdef RGB_WHITE
+    rgb_write_bytes(RGB_OUT(_px_a, _src_a, white),
+                    RGB_OUT(_px_b, _src_b, white));
+#endif /* RGB_WHITE */
   }
+#else
+  for (uint16_t led_pos = 0; led_pos < _end; led_pos++) {
+    uint16_t _src = RGB_SOURCE(led_pos);
+    rgb_t _px = RGB_PIXEL(_src);
+    rgb_write_byte(RGB_OUT(_px, _src, RGB_CHAN_0));
+    rgb_write_byte(RGB_OUT(_px, _src, RGB_CHAN_1));
+    rgb_write_byte(RGB_OUT(_px, _src, RGB_CHAN_2));
+#ifdef RGB_WHITE
+    rgb_write_byte(RGB_OUT(_px, _src, white));
+#endif /* RGB_WHITE */
+  }
+#endif /* RGB_DUAL_CHAIN */
   // Restart the interrupts, if needed
   SREG = sreg;
 }
+#endif /* RGB_DRIVER == RGB_WS2812 */
+
+#if RGB_DRIVER == RGB_APA102
+void rgb_init(void) {
+  rgb_load_state();
+
+  // Initialize SPI for sending frames - no waveform tricks needed
+  spi_settings_t _rgb_settings = {
+    .bus_mode = SPI_MASTER,
+    .bit_order = SPI_MSB_FIRST,
+    .interrupt = SPI_NO_INT,
+    .clk_mode = SPI_MODE_0,
+    .speed = SPI_DIV_2,
+  };
+  spi_init(_rgb_settings);
+}
+
+void rgb_push(void) {
+  if (!rgb_dirty) {
+    return;
+  }
+#ifdef RGB_MATRIX
+  // Dirty LEDs could be anywhere on the wire
+  rgb_dirty = rgb_num_leds;
+#endif /* RGB_MATRIX */
+  uint16_t _end = (rgb_dirty > rgb_num_leds) ? rgb_num_leds : rgb_dirty;
+  rgb_dirty = 0;
+
+  // Start frame
+  for (uint8_t _byte = 0; _byte < 4; _byte++) {
+    spi_send_block(RGB_APA102_START);
+  }
+  // Write frames - Brightness - then corrected bytes in wire order
+  for (uint16_t led_pos = 0; led_pos < _end; led_pos++) {
+    uint16_t _src = RGB_SOURCE(led_pos);
+    rgb_t _px = RGB_PIXEL(_src);
+    spi_send_block(RGB_APA102_LED | RGB_APA102_BRIGHTNESS);
+    spi_send_block(RGB_OUT(_px, _src, RGB_CHAN_0));
+    spi_send_block(RGB_OUT(_px, _src, RGB_CHAN_1));
+    spi_send_block(RGB_OUT(_px, _src, RGB_CHAN_2));
+  }
+  // End frame - data lags one clock edge per LED, so clock out N/2 more bits
+  for (uint8_t _byte = 0; _byte < 4 + (_end + 15) / 16; _byte++) {
+    spi_send_block(RGB_APA102_END);
+  }
+}
+#endif /* RGB_DRIVER == RGB_APA102 */
@@ -1,8 +1,63 @@
 /** @file RGB_LED.h
- *  @brief WS2812B LED Controller
+ *  @brief Addressable RGB LED Controller
  *
- *  Uses SPI to generate bit pulses. Interrupt-driven so *some* work may be
- *  possible between bits.
+ *  Supports two LED families, selected at build time with RGB_DRIVER:
+ *  -   RGB_WS2812: Uses SPI to generate bit pulses. Interrupt-driven so *some*
+ *      work may be possible between bits.
+ *  -   RGB_APA102: Streams APA102/SK9822 frames over SPI at full speed
+ *      (F_CPU / 2). Clocked LEDs have no timing constraints, so interrupts
+ *      are left alone.
+ *
+ *  Each channel is gamma-corrected (see `GAMMA.h`) and scaled by a global
+ *  brightness on its way out, so `rgb_led` always holds the unscaled source
+ *  values.
+ *
+ *  With RGB_DITHER, `rgb_frac` extends each channel to 8.8 fixed point. The
+ *  corrected 16-bit result is temporally dithered down to 8 bits: the
+ *  fraction left over on each push is carried into the next one, so a strip
+ *  that is pushed repeatedly (see AUTO_REFRESH) averages out to the full
+ *  precision. This costs 6 bytes of SRAM per LED, and roughly doubles the
+ *  per-channel work between bytes (see `bench/`).
+ *
+ *  RGB_FORMAT selects how `rgb_led` is stored. Everything outside this module
+ *  should go through `rgb_get()`/`rgb_set()`, which expand/pack on the fly.
+ *  SRAM per LED (N palette entries cost 3N bytes, 4N with RGB_WHITE):
+ *  -   RGB_FMT_888:  3 bytes (4 with RGB_WHITE). Full colour.
+ *  -   RGB_FMT_565:  2 bytes. 5/6/5 bits, expanded back to 8 at push.
+ *  -   RGB_FMT_PAL8: 1 byte. Index into `rgb_palette`.
+ *  -   RGB_FMT_PAL4: 1/2 byte. Index into the first 16 `rgb_palette` entries.
+ *  In the palette formats, `rgb_set()` picks the nearest palette entry, so
+ *  hosts should upload the palette first (COM_PKT_PALETTE_DATA) and then
+ *  write indices directly (COM_PKT_LED_DATA_PAL).
+ *
+ *  Writes through this module mark LEDs dirty. `rgb_push()` only shifts out
+ *  up to the last dirty LED, and does nothing when no LED has changed since
+ *  the previous push. LEDs past the end of a push keep their old colour.
+ *
+ *  With RGB_OVERLAY, a second full-colour layer, `rgb_overlay`, is blended
+ *  over `rgb_led` at push time by its per-LED `rgb_alpha` (0 transparent, 255
+ *  opaque). A highlight can then be moved by rewriting only the overlay, and
+ *  effects or fades drawing into `rgb_led` show through wherever alpha is 0.
+ *  Compositing adds a few microseconds per overlaid LED to the push loop,
+ *  between LEDs - far short of the WS2812 latch time.
+ *
+ *  SRAM per LED, per layer, against the 2 KB of an ATmega328P:
+ *  -   Base (`rgb_led`): 1/2 to 4 bytes, by RGB_FORMAT (above).
+ *  -   RGB_DITHER: +6 bytes. RGB_MATRIX: +1 byte.
+ *  -   RGB_OVERLAY: +4 bytes (5 with RGB_WHITE), whatever RGB_FORMAT.
+ *  -   FADE target and start frames: +6 bytes (8 with RGB_WHITE), unless
+ *      RGB_NO_FADE.
+ *  -   RGB_QUEUE: +3 bytes (4 with RGB_WHITE) per frame, QUE_DEPTH + 1
+ *      frames (3 by default).
+ *  -   EFFECT FIRE heat map: +1 byte, always.
+ *  So RGB_FMT_888 with RGB_OVERLAY is 14 bytes per LED (23 with RGB_QUEUE)
+ *  - 60 LEDs take 840 bytes, leaving ~1200 for the stack, COMM and
+ *  everything else. `ARCHON.c` refuses to build if the buffers leave less
+ *  than SRAM_RESERVE.
+ *
+ *  RGB_NUM_LEDS only sizes the buffers. The number of LEDs actually driven,
+ *  `rgb_num_leds`, is set at runtime with `rgb_set_num_leds()` and kept in
+ *  EEPROM, so one build can serve any strip up to RGB_NUM_LEDS long.
  *
  *  @author Patrick Dunham
  *  @bug No known bugs.
@@ -12,58 +67,523 @@
 #ifndef RGB_LED_H
 #define RGB_LED_H
 
+#include <avr/eeprom.h>
 #include <avr/interrupt.h>
 #include <avr/io.h>
 #include <stdint.h>
+#include <string.h>
 #include <util/delay_basic.h>
 
+#include "GAMMA.h"
+#include "MATH8.h"
 #include "SPI.h"
 
 
 /* -- CONFIGURATION -- */
 
-#define RGB_NUM_LEDS 20
+// Most LEDs a build can drive - see `rgb_set_num_leds()` for the active count
+#ifndef RGB_NUM_LEDS
+  #define RGB_NUM_LEDS 20
+#endif /* RGB_NUM_LEDS */
+
+// LED Drivers
+#define RGB_WS2812 0
+#define RGB_APA102 1 // Also SK9822
+
+#ifndef RGB_DRIVER
+  #define RGB_DRIVER RGB_WS2812
+#endif /* RGB_DRIVER */
+
+// APA102 global brightness field, 0-31
+#define RGB_APA102_BRIGHTNESS 31
+
+// Colour Orders (as sent on the wire)
+#define RGB_ORDER_GRB 0
+#define RGB_ORDER_RGB 1
+#define RGB_ORDER_BRG 2
+#define RGB_ORDER_BGR 3
+
+#ifndef RGB_ORDER
+  #if RGB_DRIVER == RGB_APA102
+    #define RGB_ORDER RGB_ORDER_BGR
+  #else
+    #define RGB_ORDER RGB_ORDER_GRB
+  #endif /* RGB_DRIVER */
+#endif /* RGB_ORDER */
+
+// Framebuffer Formats
+#define RGB_FMT_888  0
+#define RGB_FMT_565  1
+#define RGB_FMT_PAL8 2
+#define RGB_FMT_PAL4 3
+
+#ifndef RGB_FORMAT
+  #define RGB_FORMAT RGB_FMT_888
+#endif /* RGB_FORMAT */
+
+#if RGB_FORMAT == RGB_FMT_PAL4
+  #define RGB_PALETTE_SIZE 16
+#elif RGB_FORMAT == RGB_FMT_PAL8
+  #define RGB_PALETTE_SIZE 64 // Power of 2, up to 256
+#endif /* RGB_FORMAT */
+
+#if defined(RGB_DITHER) && RGB_FORMAT != RGB_FMT_888
+  #error "RGB_DITHER needs RGB_FMT_888"
+#endif /* RGB_DITHER */
+
+#if defined(RGB_WHITE) && RGB_FORMAT == RGB_FMT_565
+  #error "RGB_WHITE doesn't fit in RGB_FMT_565"
+#endif /* RGB_WHITE */
+
+// RGB_NO_GAMMA skips the gamma tables (for hosts that pre-correct).
+
+// RGB_DITHER adds 8 fractional bits per channel and temporal dithering.
+#if defined(RGB_DITHER) && RGB_DRIVER != RGB_WS2812
+  #error "RGB_DITHER only supports RGB_WS2812"
+#endif /* RGB_DITHER */
+
+// RGB_WHITE adds a white channel to `rgb_t`, sent after the colour channels.
+#if defined(RGB_WHITE) && RGB_DRIVER != RGB_WS2812
+  #error "RGB_WHITE only supports RGB_WS2812 (SK6812 RGBW)"
+#endif /* RGB_WHITE */
+
+// RGB_MATRIX adds `rgb_map`, so `rgb_led` order needn't match wire order.
+
+// RGB_OVERLAY adds a second layer with alpha, blended over `rgb_led` at push.
+
+// RGB_DUAL_CHAIN splits `rgb_led` across two chains. The first half goes out
+// on MOSI, the second half on TXD (PD1) with USART0 in MSPIM mode. Both chains
+// are clocked bit-for-bit together, so a push takes as long as one half. With
+// an odd `rgb_num_leds`, the first chain is one LED longer.
+#ifdef RGB_DUAL_CHAIN
+  #include "UART.h"
+
+  #if RGB_DRIVER != RGB_WS2812
+    #error "RGB_DUAL_CHAIN only supports RGB_WS2812"
+  #endif /* RGB_DRIVER */
+
+  #ifndef COM_SOFT_UART
+    #error "RGB_DUAL_CHAIN needs COM_SOFT_UART - USART0 is taken"
+  #endif /* COM_SOFT_UART */
+
+  #if RGB_NUM_LEDS % 2
+    #error "RGB_DUAL_CHAIN needs an even RGB_NUM_LEDS"
+  #endif /* RGB_NUM_LEDS % 2 */
+
+  #define RGB_CHAIN_LEDS (rgb_num_leds / 2) // Active LEDs per chain
+  #define RGB_MSPIM_UBRR 1 // 4 MHz, same as SPI_DIV_4
+#else
+  #define RGB_CHAIN_LEDS rgb_num_leds
+#endif /* RGB_DUAL_CHAIN */
 
 
 /* -- VARIABLES & DEFINITIONS -- */
 
+// WS2812 pulses
 #define RGB_MAX_BIT_POS 0b10000000
 #define RGB_HIGH_BIT    0xE0
 #define RGB_LOW_BIT     0x80
 
+// APA102 frames
+#define RGB_APA102_START     0x00 // x4
+#define RGB_APA102_LED       0xE0 // | 5-bit brightness, then RGB_ORDER
+#define RGB_APA102_END       0x00 // x4 (SK9822 reset), then 1 per 16 LEDs
+
+// `rgb_t` members in wire order. The push loops are written against these,
+// so each colour order gets its own loop at compile time.
+#if RGB_ORDER == RGB_ORDER_GRB
+  #define RGB_CHAN_0 green
+  #define RGB_CHAN_1 red
+  #define RGB_CHAN_2 blue
+#elif RGB_ORDER == RGB_ORDER_RGB
+  #define RGB_CHAN_0 red
+  #define RGB_CHAN_1 green
+  #define RGB_CHAN_2 blue
+#elif RGB_ORDER == RGB_ORDER_BRG
+  #define RGB_CHAN_0 blue
+  #define RGB_CHAN_1 red
+  #define RGB_CHAN_2 green
+#elif RGB_ORDER == RGB_ORDER_BGR
+  #define RGB_CHAN_0 blue
+  #define RGB_CHAN_1 green
+  #define RGB_CHAN_2 red
+#else
+  #error "Unknown RGB_ORDER"
+#endif /* RGB_ORDER */
+
+// Gamma table for a `rgb_t` member
+#define RGB_GAMMA(_chan)  RGB_GAMMA_(_chan)
+#define RGB_GAMMA_(_chan) gam_ ## _chan
+
+// Corrected output value for a `rgb_t` member of pixel `_px` (LED `_idx`)
+#ifdef RGB_DITHER
+  #define RGB_OUT(_px, _idx, _chan) rgb_dither((_px)._chan, \
+      rgb_frac[_idx]._chan, &rgb_err[_idx]._chan, RGB_GAMMA(_chan))
+#else
+  #define RGB_OUT(_px, _idx, _chan) rgb_correct((_px)._chan, RGB_GAMMA(_chan))
+#endif /* RGB_DITHER */
+
 // TODO: Find a better way to address this...
 typedef struct rgb_ {
   uint8_t red;
   uint8_t green;
   uint8_t blue;
+#ifdef RGB_WHITE
+  uint8_t white;
+#endif /* RGB_WHITE */
 } rgb_t;
 
-extern rgb_t rgb_led[RGB_NUM_LEDS];
+// One `rgb_led` element
+#if RGB_FORMAT == RGB_FMT_888
+  typedef rgb_t rgb_store_t;
+  #define RGB_STORE_SIZE RGB_NUM_LEDS
+#elif RGB_FORMAT == RGB_FMT_565
+  typedef uint16_t rgb_store_t;
+  #define RGB_STORE_SIZE RGB_NUM_LEDS
+#elif RGB_FORMAT == RGB_FMT_PAL8
+  typedef uint8_t rgb_store_t;
+  #define RGB_STORE_SIZE RGB_NUM_LEDS
+#elif RGB_FORMAT == RGB_FMT_PAL4
+  typedef uint8_t rgb_store_t; // Even LEDs in the low nibble
+  #define RGB_STORE_SIZE ((RGB_NUM_LEDS + 1) / 2)
+#else
+  #error "Unknown RGB_FORMAT"
+#endif /* RGB_FORMAT */
+
+#ifdef RGB_MATRIX
+  #if RGB_NUM_LEDS <= 256
+    typedef uint8_t rgb_map_t;
+  #else
+    typedef uint16_t rgb_map_t;
+  #endif /* RGB_NUM_LEDS */
+
+  // `rgb_led` index to send at each position on the wire
+  #define RGB_SOURCE(_pos) rgb_map[_pos]
+#else
+  #define RGB_SOURCE(_pos) (_pos)
+#endif /* RGB_MATRIX */
+
+// SRAM budget, in bytes - `sizeof` can't be used by the preprocessor
+#ifdef RGB_WHITE
+  #define RGB_T_BYTES 4
+#else
+  #define RGB_T_BYTES 3
+#endif /* RGB_WHITE */
+#if RGB_FORMAT == RGB_FMT_888
+  #define RGB_STORE_BYTES (RGB_STORE_SIZE * RGB_T_BYTES)
+#elif RGB_FORMAT == RGB_FMT_565
+  #define RGB_STORE_BYTES (RGB_STORE_SIZE * 2)
+#else
+  #define RGB_STORE_BYTES (RGB_STORE_SIZE + RGB_PALETTE_SIZE * RGB_T_BYTES)
+#endif /* RGB_FORMAT */
+#ifdef RGB_MATRIX
+  #define RGB_MAP_BYTES (RGB_NUM_LEDS * (RGB_NUM_LEDS <= 256 ? 1 : 2))
+#else
+  #define RGB_MAP_BYTES 0
+#endif /* RGB_MATRIX */
+#ifdef RGB_DITHER
+  #define RGB_DITHER_BYTES (RGB_NUM_LEDS * RGB_T_BYTES * 2)
+#else
+  #define RGB_DITHER_BYTES 0
+#endif /* RGB_DITHER */
+#ifdef RGB_OVERLAY
+  #define RGB_OVERLAY_BYTES (RGB_NUM_LEDS * (RGB_T_BYTES + 1))
+#else
+  #define RGB_OVERLAY_BYTES 0
+#endif /* RGB_OVERLAY */
+// Framebuffer (and palette), map, dither and overlay layers
+#define RGB_SRAM_BYTES (RGB_STORE_BYTES + RGB_MAP_BYTES + RGB_DITHER_BYTES \
+                        + RGB_OVERLAY_BYTES)
+
+#ifdef RGB_OVERLAY
+  // Colour to send for `rgb_led` index `_idx`, layers and all
+  #define RGB_PIXEL(_idx) rgb_composite(_idx)
+#else
+  #define RGB_PIXEL(_idx) rgb_get(_idx)
+#endif /* RGB_OVERLAY */
+
+// Raw framebuffer - use `rgb_get()`/`rgb_set()` unless the format is known
+extern rgb_store_t rgb_led[RGB_STORE_SIZE];
+
+#ifdef RGB_PALETTE_SIZE
+extern rgb_t rgb_palette[RGB_PALETTE_SIZE];
+#endif /* RGB_PALETTE_SIZE */
+
+#ifdef RGB_MATRIX
+// Wire position -> `rgb_led` index, filled in by `MATRIX.h`
+extern rgb_map_t rgb_map[RGB_NUM_LEDS];
+#endif /* RGB_MATRIX */
+
+// Private - brightness, use `rgb_set_brightness()`
+extern uint8_t rgb_scale;
+
+// Active LED count - use `rgb_set_num_leds()` to change
+extern uint16_t rgb_num_leds;
+
+// Private - one past the last LED changed since the last push, 0 when clean
+extern uint16_t rgb_dirty;
+
+#ifdef RGB_DITHER
+// Fractional (low) byte of each channel in `rgb_led`
+extern rgb_t rgb_frac[RGB_NUM_LEDS];
+
+// Private - dither error carried between pushes
+extern rgb_t rgb_err[RGB_NUM_LEDS];
+#endif /* RGB_DITHER */
+
+#ifdef RGB_OVERLAY
+// Overlay layer - use `rgb_set_overlay()`/`rgb_fill_overlay()` to change
+extern rgb_t rgb_overlay[RGB_NUM_LEDS];
+
+// Overlay opacity per LED, 0 (only `rgb_led` shows) to 255 (only overlay)
+extern uint8_t rgb_alpha[RGB_NUM_LEDS];
+#endif /* RGB_OVERLAY */
 
 
 /* -- PUBLIC FUNCITONS -- */
 
 /** @brief Clear RGB LED Array
  *
- *  Sets each element of the RGB array to 0. Does not push elements to array.
+ *  Sets each active element of the RGB array (and `rgb_frac`) to 0. In the
+ *  palette formats, this is palette entry 0. Does not push elements to array.
  */
 void rgb_clear(void);
 
+/** @brief Set a range of LEDs to one colour
+ *
+ *  In the palette formats, the nearest palette entry is only searched for
+ *  once.
+ *
+ *  @param _start First LED to write
+ *  @param _count Number of LEDs to write. Clipped to `rgb_num_leds`.
+ *  @param _colour Colour to write
+ *  @returns Void.
+ */
+void rgb_fill(uint16_t _start, uint16_t _count, rgb_t _colour);
+
+/** @brief Blend a range of LEDs from one colour to another
+ *
+ *  The first LED is set to `_from`, the last to `_to`, and those between to
+ *  evenly spaced `rgb_blend()`s of the two. A single LED is set to `_from`.
+ *
+ *  @param _start First LED to write
+ *  @param _count Number of LEDs to write. Clipped to `rgb_num_leds`, but the
+ *                gradient is spread over all of them.
+ *  @param _from Colour of the first LED
+ *  @param _to Colour of the last LED
+ *  @returns Void.
+ */
+void rgb_gradient(uint16_t _start, uint16_t _count, rgb_t _from, rgb_t _to);
+
+/** @brief Move a range of LEDs along, filling in behind
+ *
+ *  LEDs moved past either end of the range are dropped. Done in place, as a
+ *  block move of `rgb_led`.
+ *
+ *  @param _start First LED of the range
+ *  @param _count Number of LEDs in the range. Clipped to `rgb_num_leds`.
+ *  @param _by LEDs to move by, positive towards the end of the strip
+ *  @param _fill Colour of the LEDs left behind
+ *  @returns Void.
+ */
+void rgb_shift(uint16_t _start, uint16_t _count, int16_t _by, rgb_t _fill);
+
+/** @brief Move a range of LEDs along, wrapping around
+ *
+ *  Done in place, by three reversals of the range.
+ *
+ *  @param _start First LED of the range
+ *  @param _count Number of LEDs in the range. Clipped to `rgb_num_leds`.
+ *  @param _by LEDs to move by, positive towards the end of the strip
+ *  @returns Void.
+ */
+void rgb_rotate(uint16_t _start, uint16_t _count, int16_t _by);
+
+/** @brief Scroll a row-major matrix sideways
+ *
+ *  Treats the strip as rows of `_width` LEDs, from LED 0, and shifts each
+ *  row. LEDs past the last full row are left alone.
+ *
+ *  @param _width LEDs per row
+ *  @param _dx Columns to move by, positive towards the end of each row
+ *  @param _fill Colour of the columns left behind
+ *  @returns Void.
+ */
+void rgb_scroll_x(uint8_t _width, int8_t _dx, rgb_t _fill);
+
+/** @brief Scroll a row-major matrix up or down
+ *
+ *  Same layout as `rgb_scroll_x()`.
+ *
+ *  @param _width LEDs per row
+ *  @param _dy Rows to move by, positive towards the last row
+ *  @param _fill Colour of the rows left behind
+ *  @returns Void.
+ */
+void rgb_scroll_y(uint8_t _width, int8_t _dy, rgb_t _fill);
+
+/** @brief Mark every LED dirty
+ *
+ *  Forces the next `rgb_push()` to send the whole strip. Use after changing
+ *  anything that affects every LED (palette, brightness), or to refresh LEDs
+ *  that may have glitched.
+ *
+ *  @returns Void.
+ */
+void rgb_invalidate(void);
+
+/** @brief Copy one LED to another
+ *
+ *  Copies the stored value as-is (including `rgb_frac`), so nothing is lost
+ *  in the compact formats.
+ *
+ *  @param _dst LED to write
+ *  @param _src LED to read
+ *  @returns Void.
+ */
+void rgb_copy(uint16_t _dst, uint16_t _src);
+
+/** @brief Get the colour of one LED
+ *
+ *  Expands the stored format to a full `rgb_t`.
+ *
+ *  @param _idx LED to read. Must be less than RGB_NUM_LEDS.
+ *  @returns The LED's colour
+ */
+static inline rgb_t rgb_get(uint16_t _idx);
+
+/** @brief Set the colour of one LED
+ *
+ *  Packs a full `rgb_t` into the stored format. In the palette formats, this
+ *  searches for the nearest palette entry - use `rgb_set_index()` if the
+ *  index is already known. Clears `rgb_frac` for the LED.
+ *
+ *  @param _idx LED to write. Must be less than RGB_NUM_LEDS.
+ *  @param _colour Colour to write
+ *  @returns Void.
+ */
+static inline void rgb_set(uint16_t _idx, rgb_t _colour);
+
+/** @brief Blend two colours
+ *
+ *  @param _from Colour at `_amount` 0
+ *  @param _to Colour approached as `_amount` goes to 255
+ *  @param _amount How far from `_from` to `_to`, out of 256
+ *  @returns The blended colour
+ */
+static inline rgb_t rgb_blend(rgb_t _from, rgb_t _to, uint8_t _amount);
+
+#ifdef RGB_PALETTE_SIZE
+/** @brief Find the nearest palette entry to a colour
+ *
+ *  Linear search by sum of absolute channel differences.
+ *
+ *  @param _colour Colour to match
+ *  @returns Index of the nearest `rgb_palette` entry
+ */
+uint8_t rgb_match(rgb_t _colour);
+
+/** @brief Get the palette entry of one LED
+ *
+ *  @param _idx LED to read. Must be less than RGB_NUM_LEDS.
+ *  @returns Palette index
+ */
+static inline uint8_t rgb_get_index(uint16_t _idx);
+
+/** @brief Set one LED to a palette entry
+ *
+ *  @param _idx LED to write. Must be less than RGB_NUM_LEDS.
+ *  @param _entry Palette index. Wrapped to RGB_PALETTE_SIZE.
+ *  @returns Void.
+ */
+static inline void rgb_set_index(uint16_t _idx, uint8_t _entry);
+#endif /* RGB_PALETTE_SIZE */
+
+#ifdef RGB_OVERLAY
+/** @brief Set the overlay of one LED
+ *
+ *  The base colour in `rgb_led` is left alone.
+ *
+ *  @param _idx LED to write. Must be less than RGB_NUM_LEDS.
+ *  @param _colour Overlay colour
+ *  @param _alpha Overlay opacity, 0 (transparent) to 255 (opaque)
+ *  @returns Void.
+ */
+static inline void rgb_set_overlay(uint16_t _idx, rgb_t _colour,
+                                   uint8_t _alpha);
+
+/** @brief Set the overlay of a range of LEDs
+ *
+ *  Use alpha 0 to clear the overlay off a range.
+ *
+ *  @param _start First LED to write
+ *  @param _count Number of LEDs to write. Clipped to `rgb_num_leds`.
+ *  @param _colour Overlay colour
+ *  @param _alpha Overlay opacity, 0 (transparent) to 255 (opaque)
+ *  @returns Void.
+ */
+void rgb_fill_overlay(uint16_t _start, uint16_t _count, rgb_t _colour,
+                      uint8_t _alpha);
+#endif /* RGB_OVERLAY */
+
 /** @brief Initialize RGB LED controller
  *
- *  Initializes SPI in master mode with /4 prescaler, mode 0, MSB first, and no
- *  interrupts. SPI MOSI is configured as input ASAP. This must be combined
- *  with a pulldown resistor.
+ *  RGB_WS2812: Initializes SPI in master mode with /4 prescaler, mode 0, MSB
+ *  first, and no interrupts. SPI MOSI is configured as input ASAP. This must
+ *  be combined with a pulldown resistor. In RGB_DUAL_CHAIN builds, USART0 is
+ *  also placed in MSPIM mode at the same bit rate.
+ *
+ *  RGB_APA102: Initializes SPI in master mode with /2 prescaler, mode 0, MSB
+ *  first, and no interrupts.
+ *
+ *  Either way, `rgb_num_leds` is loaded from EEPROM. A blank or out-of-range
+ *  value falls back to RGB_NUM_LEDS. In RGB_MATRIX builds, `rgb_map` is reset
+ *  to wire order.
  *
  *  @returns Void.
  */
 void rgb_init(void);
 
+/** @brief Set the active LED count, and save it to EEPROM
+ *
+ *  Pushes, `rgb_clear()` and `rgb_invalidate()` only cover the first
+ *  `_count` LEDs. LEDs past the new end are not turned off. Blocks for the
+ *  EEPROM write (~3.4ms per byte) if the count changed.
+ *
+ *  @param _count Number of LEDs on the strip. Clamped to 1-RGB_NUM_LEDS.
+ *                RGB_DUAL_CHAIN builds ignore odd counts, as both chains
+ *                must be the same length.
+ *  @returns Void.
+ */
+void rgb_set_num_leds(uint16_t _count);
+
+/** @brief Set global brightness
+ *
+ *  Applied to every channel after gamma correction at push time. The
+ *  contents of `rgb_led` are not touched, but every LED is marked dirty.
+ *  Does not push.
+ *
+ *  @param _level Brightness, 0 (off) to 255 (full)
+ *  @returns Void.
+ */
+void rgb_set_brightness(uint8_t _level);
+
 /** @brief Push updates to LED strip.
  *
- *  The rgb_led array is pushed to the LEDs in GRB order as fast as possible
- *  using SPI. A delay of at least 6us must occur between calls for the LEDs
- *  to latch. Interrupts will be disabled for the entirety of the function.
+ *  RGB_WS2812: The rgb_led array is pushed to the LEDs in RGB_ORDER (then
+ *  white, for RGB_WHITE) as fast as possible using SPI. A delay of at least
+ *  6us must occur between calls for the LEDs to latch. Interrupts will be
+ *  disabled for the entirety of the function.
+ *
+ *  RGB_APA102: A start frame, one brightness + BGR frame per LED, and an end
+ *  frame are sent by polling SPI at 8 MHz (~2.5us per LED). Interrupts stay
+ *  enabled, and LEDs latch as soon as the end frame is clocked out.
+ *
+ *  Either way, only LEDs up to the last dirty one are sent, and nothing is
+ *  sent if none are dirty. In RGB_DUAL_CHAIN builds, a dirty LED in the
+ *  second chain sends the full length of both chains. In RGB_MATRIX builds,
+ *  LEDs are sent in `rgb_map` order, and any dirty LED sends all of them. In
+ *  RGB_OVERLAY builds, each LED is blended with its overlay on the way out.
  *
  * NOTE: Configured for 16 MHz clock.
  *
@@ -72,9 +592,216 @@ void rgb_init(void);
 void rgb_push(void);
 
 
+/* -- INLINE FUNCTIONS -- */
+
+/** @brief Mark one LED dirty (private)
+ *
+ *  @param _idx LED that was written
+ *  @returns Void.
+ */
+static inline void rgb_touch(uint16_t _idx) {
+  if (_idx >= rgb_dirty) {
+    rgb_dirty = _idx + 1;
+  }
+}
+
+static inline rgb_t rgb_get(uint16_t _idx) {
+#if RGB_FORMAT == RGB_FMT_888
+  return rgb_led[_idx];
+#elif RGB_FORMAT == RGB_FMT_565
+  // Replicate the top bits down, so full scale stays full scale
+  uint16_t _raw = rgb_led[_idx];
+  uint8_t _red = (_raw >> 8) & 0xF8;
+  uint8_t _green = (_raw >> 3) & 0xFC;
+  uint8_t _blue = _raw << 3;
+  return (rgb_t){
+    .red = _red | (_red >> 5),
+    .green = _green | (_green >> 6),
+    .blue = _blue | (_blue >> 5),
+  };
+#else
+  return rgb_palette[rgb_get_index(_idx)];
+#endif /* RGB_FORMAT */
+}
+
+static inline void rgb_set(uint16_t _idx, rgb_t _colour) {
+#if RGB_FORMAT == RGB_FMT_888
+  rgb_led[_idx] = _colour;
+  rgb_touch(_idx);
+#elif RGB_FORMAT == RGB_FMT_565
+  rgb_led[_idx] = ((uint16_t)(_colour.red & 0xF8) << 8)
+                | ((uint16_t)(_colour.green & 0xFC) << 3)
+                | (_colour.blue >> 3);
+  rgb_touch(_idx);
+#else
+  rgb_set_index(_idx, rgb_match(_colour));
+#endif /* RGB_FORMAT */
+
+#ifdef RGB_DITHER
+  rgb_frac[_idx] = (rgb_t){0};
+#endif /* RGB_DITHER */
+}
+
+static inline rgb_t rgb_blend(rgb_t _from, rgb_t _to, uint8_t _amount) {
+  return (rgb_t){
+    .red = mth_blend8(_from.red, _to.red, _amount),
+    .green = mth_blend8(_from.green, _to.green, _amount),
+    .blue = mth_blend8(_from.blue, _to.blue, _amount),
+#ifdef RGB_WHITE
+    .white = mth_blend8(_from.white, _to.white, _amount),
+#endif /* RGB_WHITE */
+  };
+}
+
+#ifdef RGB_PALETTE_SIZE
+static inline uint8_t rgb_get_index(uint16_t _idx) {
+#if RGB_FORMAT == RGB_FMT_PAL8
+  return rgb_led[_idx] & (RGB_PALETTE_SIZE - 1);
+#else
+  uint8_t _pair = rgb_led[_idx >> 1];
+  return (_idx & 1) ? (_pair >> 4) : (_pair & 0x0F);
+#endif /* RGB_FORMAT */
+}
+
+static inline void rgb_set_index(uint16_t _idx, uint8_t _entry) {
+  _entry &= (RGB_PALETTE_SIZE - 1);
+#if RGB_FORMAT == RGB_FMT_PAL8
+  rgb_led[_idx] = _entry;
+#else
+  uint8_t *_pair = &rgb_led[_idx >> 1];
+  if (_idx & 1) {
+    *_pair = (*_pair & 0x0F) | (_entry << 4);
+  } else {
+    *_pair = (*_pair & 0xF0) | _entry;
+  }
+#endif /* RGB_FORMAT */
+  rgb_touch(_idx);
+}
+#endif /* RGB_PALETTE_SIZE */
+
+#ifdef RGB_OVERLAY
+static inline void rgb_set_overlay(uint16_t _idx, rgb_t _colour,
+                                   uint8_t _alpha) {
+  rgb_overlay[_idx] = _colour;
+  rgb_alpha[_idx] = _alpha;
+  rgb_touch(_idx);
+}
+
+/** @brief Blend the overlay over one LED (private)
+ *
+ *  The ends are exact - alpha 255 is the overlay alone, not 255/256 of it.
+ *  In RGB_DITHER builds, `rgb_frac` of the base still dithers the result
+ *  (an error of under one step).
+ *
+ *  @param _idx LED to read. Must be less than RGB_NUM_LEDS.
+ *  @returns The colour to send
+ */
+static inline rgb_t rgb_composite(uint16_t _idx) {
+  uint8_t _alpha = rgb_alpha[_idx];
+  if (_alpha == 0) {
+    return rgb_get(_idx);
+  } else if (_alpha == 255) {
+    return rgb_overlay[_idx];
+  }
+  return rgb_blend(rgb_get(_idx), rgb_overlay[_idx], _alpha);
+}
+#endif /* RGB_OVERLAY */
+
+
 /* -- PRIVATE FUNCTIONS -- */
 
-/** @brief Write one byte to RGB LED
+/** @brief Set up state shared by both drivers
+ *
+ *  Loads `rgb_num_leds` from EEPROM, falling back to RGB_NUM_LEDS if the
+ *  stored value is blank or out of range. Resets `rgb_map` to wire order.
+ *
+ *  @returns Void.
+ */
+static void rgb_load_state(void);
+
+/** @brief Clip a range of LEDs to `rgb_num_leds`
+ *
+ *  @param _start First LED of the range
+ *  @param _count Number of LEDs in the range
+ *  @returns Number of LEDs of the range that exist (0 if none)
+ */
+static uint16_t rgb_clip(uint16_t _start, uint16_t _count);
+
+/** @brief Move LEDs (and `rgb_frac`) within `rgb_led`
+ *
+ *  Ranges may overlap. Both must already be clipped.
+ *
+ *  @param _dst First LED to write
+ *  @param _src First LED to read
+ *  @param _count Number of LEDs to move
+ *  @returns Void.
+ */
+static void rgb_move(uint16_t _dst, uint16_t _src, uint16_t _count);
+
+/** @brief Reverse the order of a range of LEDs in place
+ *
+ *  @param _start First LED of the range (already clipped)
+ *  @param _count Number of LEDs in the range (already clipped)
+ *  @returns Void.
+ */
+static void rgb_reverse(uint16_t _start, uint16_t _count);
+
+/** @brief Gamma-correct and scale one channel for output
+ *
+ *  Costs one flash read and one multiply - cheap enough to run between
+ *  WS2812 bytes.
+ *
+ *  @param _value Source channel value, from `rgb_get()`
+ *  @param _table Gamma table for the channel (see `RGB_GAMMA()`)
+ *  @returns Value to send to the LED
+ */
+static inline uint8_t rgb_correct(uint8_t _value, const uint8_t *_table) {
+#ifndef RGB_NO_GAMMA
+  _value = gam_lookup(_table, _value);
+#endif /* RGB_NO_GAMMA */
+  return mth_scale8(_value, rgb_scale);
+}
+
+#ifdef RGB_DITHER
+/** @brief Gamma-correct, scale & dither one 8.8 channel for output
+ *
+ *  The gamma table is linearly interpolated by the fractional byte, giving a
+ *  corrected 8.8 value that is then scaled by brightness. The leftover
+ *  fraction is added to `*_err`, and carried out into the result when it
+ *  overflows.
+ *
+ *  @param _value Source channel value, from `rgb_get()`
+ *  @param _frac Source fraction from `rgb_frac`
+ *  @param _err Dither error for this channel, updated in place
+ *  @param _table Gamma table for the channel (see `RGB_GAMMA()`)
+ *  @returns Value to send to the LED
+ */
+static inline uint8_t rgb_dither(uint8_t _value, uint8_t _frac,
+                                 uint8_t *_err, const uint8_t *_table) {
+#ifndef RGB_NO_GAMMA
+  uint8_t _lo = gam_lookup(_table, _value);
+  uint8_t _hi = (_value == 0xFF) ? _lo : gam_lookup(_table, _value + 1);
+#else
+  uint8_t _lo = _value;
+  uint8_t _hi = (_value == 0xFF) ? _lo : _value + 1;
+#endif /* RGB_NO_GAMMA */
+
+  // Interpolate - never exceeds 0xFF00, so there's room for the error
+  uint16_t _exact = ((uint16_t)_lo << 8) + (uint8_t)(_hi - _lo) * _frac;
+
+  // Scale, keeping the fraction
+  _exact = (_exact >> 8) * (rgb_scale + 1)
+           + mth_scale8((uint8_t)_exact, rgb_scale);
+
+  _exact += *_err;
+  *_err = _exact & 0xFF;
+
+  return _exact >> 8;
+}
+#endif /* RGB_DITHER */
+
+#if RGB_DRIVER == RGB_WS2812
+/** @brief Write one bit to RGB LED
  *
  *  Wrapper for SPI write that ensures MOSI is low between bits.
  *
@@ -91,4 +818,52 @@ static inline void rgb_write_bit(uint8_t _bit) {
   SPI_DDR &= ~(1 << SPI_MOSI);
 }
 
+/** @brief Write one colour channel to RGB LED, MSB first
+ *
+ *  @param _byte The channel value to send to the WS2812B.
+ *  @returns Void.
+ */
+static inline void rgb_write_byte(uint8_t _byte) {
+  for (uint8_t bit_pos = RGB_MAX_BIT_POS; bit_pos != 0; bit_pos >>= 1) {
+    rgb_write_bit(_byte & bit_pos);
+  }
+}
+
+#ifdef RGB_DUAL_CHAIN
+/** @brief Write one bit to each RGB LED chain
+ *
+ *  Same as `rgb_write_bit()`, but also loads the second chain's pulse into
+ *  UDR0. TXD can't be tristated while the transmitter is enabled - it holds
+ *  the trailing 0 of each pulse instead.
+ *
+ *  NOTE: Configured for 16 MHz clock.
+ *
+ *  @param _bit_a The bit to send to the SPI chain. Anything not 0 is 1.
+ *  @param _bit_b The bit to send to the MSPIM chain. Anything not 0 is 1.
+ *  @returns Void.
+ */
+static inline void rgb_write_bits(uint8_t _bit_a, uint8_t _bit_b) {
+  uint8_t _write_a = (_bit_a) ? RGB_HIGH_BIT : RGB_LOW_BIT;
+  uint8_t _write_b = (_bit_b) ? RGB_HIGH_BIT : RGB_LOW_BIT;
+  SPI_DDR |= (1 << SPI_MOSI);
+  spi_send(_write_a);
+  UDR0 = _write_b;
+  _delay_loop_1(3);
+  SPI_DDR &= ~(1 << SPI_MOSI);
+}
+
+/** @brief Write one colour channel to each RGB LED chain, MSB first
+ *
+ *  @param _byte_a The channel value to send to the SPI chain.
+ *  @param _byte_b The channel value to send to the MSPIM chain.
+ *  @returns Void.
+ */
+static inline void rgb_write_bytes(uint8_t _byte_a, uint8_t _byte_b) {
+  for (uint8_t bit_pos = RGB_MAX_BIT_POS; bit_pos != 0; bit_pos >>= 1) {
+    rgb_write_bits(_byte_a & bit_pos, _byte_b & bit_pos);
+  }
+}
+#endif /* RGB_DUAL_CHAIN */
+#endif /* RGB_DRIVER */
+
 #endif /* RGB_LED_H */
@@ -0,0 +1,62 @@
+/** @file SCENE.c
+ *  @brief Preset looks, saved in EEPROM
+ *
+ *  This contains the implementation for the interface described in `SCENE.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "SCENE.h"
+
+
+/* -- VARIABLES -- */
+
+#define SCN_VALID 0xA5 // Anything but blank EEPROM
+
+static scn_slot_t EEMEM scn_slots_ee[SCN_SLOTS];
+static uint8_t EEMEM scn_power_on_ee = SCN_NONE;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void scn_save(uint8_t _slot) {
+  if (_slot >= SCN_SLOTS) {
+    return;
+  }
+  scn_slot_t *_ee = &scn_slots_ee[_slot];
+
+  eeprom_update_block(rgb_led, _ee->leds, sizeof(rgb_led));
+#ifdef RGB_PALETTE_SIZE
+  eeprom_update_block(rgb_palette, _ee->palette, sizeof(rgb_palette));
+#endif /* RGB_PALETTE_SIZE */
+  eeprom_update_byte(&_ee->valid, SCN_VALID);
+}
+
+uint8_t scn_load(uint8_t _slot) {
+  if (_slot >= SCN_SLOTS) {
+    return 0;
+  }
+  scn_slot_t *_ee = &scn_slots_ee[_slot];
+  if (eeprom_read_byte(&_ee->valid) != SCN_VALID) {
+    return 0;
+  }
+
+  // Clears `rgb_frac`, and marks every LED dirty
+  rgb_clear();
+  eeprom_read_block(rgb_led, _ee->leds, sizeof(rgb_led));
+#ifdef RGB_PALETTE_SIZE
+  eeprom_read_block(rgb_palette, _ee->palette, sizeof(rgb_palette));
+#endif /* RGB_PALETTE_SIZE */
+
+  return 1;
+}
+
+void scn_set_power_on(uint8_t _slot) {
+  eeprom_update_byte(&scn_power_on_ee, _slot);
+}
+
+uint8_t scn_load_power_on(void) {
+  return scn_load(eeprom_read_byte(&scn_power_on_ee));
+}
@@ -0,0 +1,114 @@
+/** @file SCENE.h
+ *  @brief Preset looks, saved in EEPROM
+ *
+ *  Each of the SCN_SLOTS slots holds a copy of `rgb_led`, exactly as stored
+ *  (so RGB_FORMAT compresses scenes too), and in the palette formats the
+ *  palette as well. A saved scene can be recalled with one short command,
+ *  and one slot can be picked to be shown at power on, before the host is
+ *  even connected.
+ *
+ *  EEPROM per slot is the size of `rgb_led` (plus `rgb_palette`), plus 1
+ *  byte, and the power-on slot takes 1 more. The ATmega328P has 1 KB, shared
+ *  with `VM.h` (129 bytes), `SEGMENT.h` (40), `MATRIX.h` (3, plus up to 2
+ *  per LED), `RGB_LED.h` (2) and `ANIM.h` (1) - lower SCN_SLOTS for long
+ *  strips or the palette formats. The build fails if they don't all fit.
+ *
+ *  Only the 8-bit colours are saved. In RGB_DITHER builds, `rgb_frac` is
+ *  cleared by a recall.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <avr/eeprom.h>
+#include <stdint.h>
+
+#include "RGB_LED.h"
+#include "SEGMENT.h"
+#include "VM.h"
+
+
+/* -- CONFIGURATION -- */
+
+#ifndef SCN_SLOTS
+  #if RGB_FORMAT == RGB_FMT_PAL8
+    #define SCN_SLOTS 3 // Each slot carries the 64-entry palette
+  #else
+    #define SCN_SLOTS 4
+  #endif /* RGB_FORMAT */
+#endif /* SCN_SLOTS */
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// No scene - e.g. for `scn_set_power_on()`
+#define SCN_NONE 0xFF
+
+typedef struct scn_slot_ {
+  rgb_store_t leds[RGB_STORE_SIZE];
+#ifdef RGB_PALETTE_SIZE
+  rgb_t palette[RGB_PALETTE_SIZE];
+#endif /* RGB_PALETTE_SIZE */
+  uint8_t valid;
+} scn_slot_t;
+
+// EEPROM budget, in bytes - `sizeof` can't be used by the preprocessor
+#define SCN_SLOT_BYTES (RGB_STORE_BYTES + 1)
+#ifdef RGB_MATRIX
+  #define SCN_MTX_BYTES (3 + RGB_MAP_BYTES)
+#else
+  #define SCN_MTX_BYTES 0
+#endif /* RGB_MATRIX */
+// Scenes and power-on slot, VM, SEGMENT (5 per segment), MATRIX, RGB_LED
+// and ANIM
+#define SCN_EE_BYTES (SCN_SLOTS * SCN_SLOT_BYTES + 1 \
+                      + VM_PROGRAM_SIZE + 1 + SEG_MAX * 5 + SCN_MTX_BYTES \
+                      + 2 + 1)
+
+#if SCN_EE_BYTES > E2END + 1
+  #error "EEPROM is full - lower SCN_SLOTS (or RGB_NUM_LEDS)"
+#endif /* SCN_EE_BYTES */
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Save the LEDs to a slot
+ *
+ *  Blocks for the EEPROM writes (~3.4ms per changed byte).
+ *
+ *  @param _slot Slot to save to. Ignored if not less than SCN_SLOTS.
+ *  @returns Void.
+ */
+void scn_save(uint8_t _slot);
+
+/** @brief Recall a saved scene into the LEDs
+ *
+ *  Every LED is marked dirty. Does not push.
+ *
+ *  @param _slot Slot to recall
+ *  @returns 1 if the scene was recalled, 0 if the slot is empty or invalid
+ */
+uint8_t scn_load(uint8_t _slot);
+
+/** @brief Choose the scene shown at power on, and save it to EEPROM
+ *
+ *  @param _slot Slot to show, or SCN_NONE for none. Empty slots show
+ *               nothing.
+ *  @returns Void.
+ */
+void scn_set_power_on(uint8_t _slot);
+
+/** @brief Recall the power-on scene, if there is one
+ *
+ *  Call once at start up, after `rgb_init()`. Does not push.
+ *
+ *  @returns 1 if a scene was recalled, 0 otherwise
+ */
+uint8_t scn_load_power_on(void);
+
+
+#endif /* SCENE_H */
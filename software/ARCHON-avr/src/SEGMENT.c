@@ -0,0 +1,167 @@
+/** @file SEGMENT.c
+ *  @brief Named LED segments
+ *
+ *  This contains the implementation for the interface described in
+ *  `SEGMENT.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "SEGMENT.h"
+
+
+/* -- VARIABLES -- */
+
+#define SEG_FLAGS ((1 << SEG_REVERSE) | (1 << SEG_MIRROR))
+
+seg_t seg_table[SEG_MAX];
+
+static seg_t EEMEM seg_table_ee[SEG_MAX];
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void seg_init(void) {
+  eeprom_read_block(seg_table, seg_table_ee, sizeof(seg_table));
+
+  // Blank EEPROM reads as 0xFF, which fails all of these
+  for (uint8_t _id = 0; _id < SEG_MAX; _id++) {
+    seg_t *_seg = &seg_table[_id];
+    if (_seg->start >= RGB_NUM_LEDS ||
+        _seg->length > RGB_NUM_LEDS - _seg->start ||
+        (_seg->flags & ~SEG_FLAGS)) {
+      _seg->length = 0;
+    }
+  }
+}
+
+void seg_define(uint8_t _id, uint16_t _start, uint16_t _length,
+                uint8_t _flags) {
+  if (_id >= SEG_MAX) {
+    return;
+  }
+  seg_t *_seg = &seg_table[_id];
+
+  if (_start >= RGB_NUM_LEDS) {
+    _length = 0;
+  } else if (_length > RGB_NUM_LEDS - _start) {
+    _length = RGB_NUM_LEDS - _start;
+  }
+  _seg->start = _start;
+  _seg->length = _length;
+  _seg->flags = _flags & SEG_FLAGS;
+
+  eeprom_update_block(_seg, &seg_table_ee[_id], sizeof(seg_t));
+}
+
+void seg_set(uint8_t _id, uint16_t _pos, rgb_t _colour) {
+  uint16_t _start, _count;
+  seg_range(_id, &_start, &_count);
+  if (_pos >= _count) {
+    return;
+  }
+
+  if (seg_table[_id].flags & (1 << SEG_REVERSE)) {
+    _pos = _count - 1 - _pos;
+  }
+  if (_start + _pos < rgb_num_leds) {
+    rgb_set(_start + _pos, _colour);
+  }
+
+  // Just the one LED, not the whole half
+  if (seg_table[_id].flags & (1 << SEG_MIRROR)) {
+    uint16_t _twin = _start + seg_table[_id].length - 1 - _pos;
+    if (_twin < rgb_num_leds) {
+      rgb_set(_twin, _colour);
+    }
+  }
+}
+
+void seg_fill(uint8_t _id, rgb_t _colour) {
+  if (_id >= SEG_MAX) {
+    return;
+  }
+  rgb_fill(seg_table[_id].start, seg_table[_id].length, _colour);
+}
+
+#ifndef RGB_NO_FADE
+void seg_fade(uint8_t _id, uint16_t _duration, rgb_t _colour) {
+  if (_id >= SEG_MAX || seg_table[_id].length == 0) {
+    return;
+  }
+
+  // Nothing else fading - everything else fades to what it is now
+  if (!fad_active()) {
+    for (uint16_t _led = 0; _led < rgb_num_leds; _led++) {
+      fad_target[_led] = rgb_get(_led);
+    }
+  }
+  uint16_t _end = seg_table[_id].start + seg_table[_id].length;
+  for (uint16_t _led = seg_table[_id].start; _led < _end; _led++) {
+    fad_target[_led] = _colour;
+  }
+
+  fad_start(_duration);
+}
+#endif /* RGB_NO_FADE */
+
+void seg_shift(uint8_t _id, int16_t _by, rgb_t _fill) {
+  if (_id >= SEG_MAX) {
+    return;
+  }
+  uint16_t _start, _count;
+  seg_range(_id, &_start, &_count);
+
+  if (seg_table[_id].flags & (1 << SEG_REVERSE)) {
+    _by = -_by;
+  }
+  rgb_shift(_start, _count, _by, _fill);
+  seg_mirror(_id);
+}
+
+void seg_rotate(uint8_t _id, int16_t _by) {
+  if (_id >= SEG_MAX) {
+    return;
+  }
+  uint16_t _start, _count;
+  seg_range(_id, &_start, &_count);
+
+  if (seg_table[_id].flags & (1 << SEG_REVERSE)) {
+    _by = -_by;
+  }
+  rgb_rotate(_start, _count, _by);
+  seg_mirror(_id);
+}
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+static void seg_range(uint8_t _id, uint16_t *_start, uint16_t *_count) {
+  if (_id >= SEG_MAX) {
+    *_start = 0;
+    *_count = 0;
+    return;
+  }
+
+  *_start = seg_table[_id].start;
+  *_count = seg_table[_id].length;
+  if (seg_table[_id].flags & (1 << SEG_MIRROR)) {
+    *_count = (*_count + 1) / 2;
+  }
+}
+
+static void seg_mirror(uint8_t _id) {
+  if (_id >= SEG_MAX || !(seg_table[_id].flags & (1 << SEG_MIRROR))) {
+    return;
+  }
+
+  uint16_t _start = seg_table[_id].start;
+  uint16_t _last = _start + seg_table[_id].length - 1;
+  for (uint16_t _pos = 0; _start + _pos < _last - _pos; _pos++) {
+    if (_last - _pos < rgb_num_leds) {
+      rgb_copy(_last - _pos, _start + _pos);
+    }
+  }
+}
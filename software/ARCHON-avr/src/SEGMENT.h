@@ -0,0 +1,148 @@
+/** @file SEGMENT.h
+ *  @brief Named LED segments
+ *
+ *  Up to SEG_MAX segments, each a range of LEDs that can be set, filled,
+ *  faded or shifted as a whole by its ID. Positions within a segment are
+ *  counted from 0, and flags change how they land on the strip:
+ *  -   SEG_REVERSE: Position 0 is the last LED of the range.
+ *  -   SEG_MIRROR: The range is split in half, and every write to the first
+ *      half is mirrored onto the second - so position 0 is at both ends
+ *      (or, with SEG_REVERSE, both middles). Only (length + 1) / 2 positions
+ *      exist.
+ *  Segments may overlap. The table is kept in EEPROM, and costs 5 bytes of
+ *  SRAM per segment.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef SEGMENT_H
+#define SEGMENT_H
+
+#include <avr/eeprom.h>
+#include <stdint.h>
+
+#include "FADE.h"
+#include "RGB_LED.h"
+
+
+/* -- CONFIGURATION -- */
+
+#define SEG_MAX 8
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// Segment Flags
+#define SEG_REVERSE 0
+#define SEG_MIRROR  1
+
+typedef struct seg_ {
+  uint16_t start;
+  uint16_t length; // 0 if the segment isn't defined
+  uint8_t flags;
+} seg_t;
+
+// Segment table - use `seg_define()` to change
+extern seg_t seg_table[SEG_MAX];
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Load the segment table from EEPROM
+ *
+ *  Entries that are blank or don't fit in RGB_NUM_LEDS are left undefined.
+ *
+ *  @returns Void.
+ */
+void seg_init(void);
+
+/** @brief Define a segment, and save it to EEPROM
+ *
+ *  Blocks for the EEPROM writes (~3.4ms per changed byte).
+ *
+ *  @param _id Segment to define. Ignored if not less than SEG_MAX.
+ *  @param _start First LED of the segment
+ *  @param _length Number of LEDs, 0 to undefine. Clipped to RGB_NUM_LEDS.
+ *  @param _flags SEG_REVERSE and/or SEG_MIRROR bits
+ *  @returns Void.
+ */
+void seg_define(uint8_t _id, uint16_t _start, uint16_t _length,
+                uint8_t _flags);
+
+/** @brief Set one position of a segment
+ *
+ *  @param _id Segment to write
+ *  @param _pos Position within the segment
+ *  @param _colour Colour to write
+ *  @returns Void.
+ */
+void seg_set(uint8_t _id, uint16_t _pos, rgb_t _colour);
+
+/** @brief Set a whole segment to one colour
+ *
+ *  @param _id Segment to write
+ *  @param _colour Colour to write
+ *  @returns Void.
+ */
+void seg_fill(uint8_t _id, rgb_t _colour);
+
+#ifndef RGB_NO_FADE
+/** @brief Fade a whole segment to one colour
+ *
+ *  Not built with RGB_NO_FADE. Uses `FADE.h`, so it restarts any running
+ *  fade from where it got to - other segments that were fading carry on
+ *  towards the same targets, but over the new duration. LEDs outside any
+ *  fade stay as they are.
+ *
+ *  @param _id Segment to fade
+ *  @param _duration Length of the fade [ms]
+ *  @param _colour Colour to fade to
+ *  @returns Void.
+ */
+void seg_fade(uint8_t _id, uint16_t _duration, rgb_t _colour);
+#endif /* RGB_NO_FADE */
+
+/** @brief Move a segment along, filling in behind
+ *
+ *  @param _id Segment to shift
+ *  @param _by Positions to move by, positive away from position 0
+ *  @param _fill Colour of the positions left behind
+ *  @returns Void.
+ */
+void seg_shift(uint8_t _id, int16_t _by, rgb_t _fill);
+
+/** @brief Move a segment along, wrapping around
+ *
+ *  @param _id Segment to rotate
+ *  @param _by Positions to move by, positive away from position 0
+ *  @returns Void.
+ */
+void seg_rotate(uint8_t _id, int16_t _by);
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+/** @brief Get the LEDs written by a segment
+ *
+ *  For SEG_MIRROR segments, this is only the first half.
+ *
+ *  @param _id Segment to look up
+ *  @param _start First LED, returned
+ *  @param _count Number of LEDs, returned. 0 if the segment is undefined.
+ *  @returns Void.
+ */
+static void seg_range(uint8_t _id, uint16_t *_start, uint16_t *_count);
+
+/** @brief Copy the first half of a SEG_MIRROR segment onto the second
+ *
+ *  Does nothing for other segments.
+ *
+ *  @param _id Segment to mirror
+ *  @returns Void.
+ */
+static void seg_mirror(uint8_t _id);
+
+
+#endif /* SEGMENT_H */
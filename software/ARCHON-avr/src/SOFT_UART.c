@@ -0,0 +1,120 @@
+/** @file SOFT_UART.c
+ *  @brief Interrupt-driven software UART on INT0 & TIMER2.
+ *
+ *  This contains the implementation for the interface described in
+ *  `SOFT_UART.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No framing error detection.
+ *  @version 0.0.1
+ */
+
+#include "SOFT_UART.h"
+
+#ifdef COM_SOFT_UART
+
+/* -- VARIABLES -- */
+
+static uint8_t swu_bit_ticks;
+
+static volatile uint8_t swu_rx_data;
+static volatile uint8_t swu_rx_shift;
+static volatile uint8_t swu_rx_bit;
+
+static volatile uint8_t swu_tx_shift;
+static volatile uint8_t swu_tx_bit;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void swu_init(uint16_t _baud) {
+  swu_bit_ticks = F_CPU / SWU_PRESCALER / _baud;
+
+  // TX idles high, RX is pulled up
+  SWU_PORT |= (1 << SWU_TX) | (1 << SWU_RX);
+  SWU_DDR |= (1 << SWU_TX);
+  SWU_DDR &= ~(1 << SWU_RX);
+
+  // Free-running TIMER2 at /32
+  TCCR2A = 0;
+  TCCR2B = (1 << CS21) | (1 << CS20);
+  TIMSK2 = 0;
+
+  // Falling edge on INT0 marks a start bit
+  EICRA = (EICRA & ~((1 << ISC01) | (1 << ISC00))) | (1 << ISC01);
+  EIFR = (1 << INTF0);
+  EIMSK |= (1 << INT0);
+}
+
+uint8_t swu_recv(void) {
+  return swu_rx_data;
+}
+
+void swu_send(uint8_t _data) {
+  swu_tx_shift = _data;
+  swu_tx_bit = 0;
+
+  // Start bit goes out now, data bits on each compare match
+  SWU_PORT &= ~(1 << SWU_TX);
+  OCR2B = TCNT2 + swu_bit_ticks;
+  TIFR2 = (1 << OCF2B);
+  TIMSK2 |= (1 << OCIE2B);
+}
+
+
+/* -- ISRS -- */
+
+ISR(INT0_vect) {
+  // Ignore edges until the character is done, sample middle of first bit
+  EIMSK &= ~(1 << INT0);
+  OCR2A = TCNT2 + swu_bit_ticks + (swu_bit_ticks >> 1);
+  TIFR2 = (1 << OCF2A);
+  TIMSK2 |= (1 << OCIE2A);
+
+  swu_rx_shift = 0;
+  swu_rx_bit = 0;
+}
+
+ISR(TIMER2_COMPA_vect) {
+  if (swu_rx_bit < 8) {
+    // Data bits arrive LSB first
+    swu_rx_shift >>= 1;
+    if (SWU_PIN & (1 << SWU_RX)) {
+      swu_rx_shift |= 0x80;
+    }
+    swu_rx_bit++;
+    OCR2A += swu_bit_ticks;
+  } else {
+    // Middle of the stop bit - hand off and wait for the next start bit
+    TIMSK2 &= ~(1 << OCIE2A);
+    swu_rx_data = swu_rx_shift;
+    EIFR = (1 << INTF0);
+    EIMSK |= (1 << INT0);
+
+    swu_rx_complete();
+  }
+}
+
+ISR(TIMER2_COMPB_vect) {
+  if (swu_tx_bit < 8) {
+    if (swu_tx_shift & 0x01) {
+      SWU_PORT |= (1 << SWU_TX);
+    } else {
+      SWU_PORT &= ~(1 << SWU_TX);
+    }
+    swu_tx_shift >>= 1;
+  } else if (swu_tx_bit == 8) {
+    // Stop bit
+    SWU_PORT |= (1 << SWU_TX);
+  } else {
+    // Stop bit has been on the line for a full period
+    TIMSK2 &= ~(1 << OCIE2B);
+    swu_tx_complete();
+    return;
+  }
+
+  swu_tx_bit++;
+  OCR2B += swu_bit_ticks;
+}
+
+#endif /* COM_SOFT_UART */
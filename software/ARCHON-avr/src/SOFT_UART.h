@@ -0,0 +1,106 @@
+/** @file SOFT_UART.h
+ *  @brief Interrupt-driven software UART on INT0 & TIMER2.
+ *
+ *  Full-duplex 8-N-1 UART for when USART0 is busy doing something else (e.g.
+ *  driving a second LED chain in MSPIM mode). RX is on INT0 (PD2), TX is on
+ *  PD3. TIMER2 free-runs at F_CPU / 32, and each direction gets its own
+ *  compare channel (A for RX, B for TX) that is advanced by one bit period per
+ *  interrupt.
+ *
+ *  The interface mirrors `UART.h`, and the interrupt behaviour mirrors the
+ *  USART RX & TX complete interrupts - after each character, one of
+ *  `swu_rx_complete()` or `swu_tx_complete()` is called from ISR context.
+ *
+ *  Only built when `COM_SOFT_UART` is defined, as the ISRs would otherwise
+ *  claim INT0 & TIMER2 in every build.
+ *
+ *  NOTE: Bits are dropped if interrupts are disabled for more than a fraction
+ *        of a bit period. Don't transmit or receive across `rgb_push()`.
+ *  WARNING: Any previous configuration of TIMER2 and INT0 will be overwritten.
+ *
+ *  @author Patrick Dunham
+ *  @bug No framing error detection.
+ *  @version 0.0.1
+ */
+
+#ifndef SOFT_UART_H
+#define SOFT_UART_H
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <stdint.h>
+
+
+/* -- CONFIGURATION -- */
+
+#ifndef F_CPU
+  #define F_CPU 16000000UL
+#endif /* F_CPU */
+
+#define SWU_PRESCALER 32
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// Soft UART Port Definitions
+#define SWU_DDR  DDRD
+#define SWU_PORT PORTD
+#define SWU_PIN  PIND
+
+// Soft UART Pin Definitions
+#define SWU_RX   PIND2
+#define SWU_TX   PIND3
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Initialize software UART to _baud at 8-N-1 w/ TX and RX.
+ *
+ *  Configures TIMER2 as a free-running /32 timebase, INT0 as the start bit
+ *  detector, and PD3 as an idle-high output. Baud rates from 4800 to 19200
+ *  are supported at 16 MHz (1.5 bit periods must fit in TIMER2).
+ *
+ *  @param _baud Baud rate to configure UART for [bps]
+ *  @returns Void.
+ */
+void swu_init(uint16_t _baud);
+
+/** @brief Recieves a character from the software UART buffer.
+ *
+ *  Will return immediatly with the last completed character.
+ *
+ *  @returns The raw byte received
+ */
+uint8_t swu_recv(void);
+
+/** @brief Starts sending a single character over the software UART.
+ *
+ *  Will return immediatly. Anything currently being sent is clobbered - wait
+ *  for `swu_tx_complete()` before sending the next character.
+ *
+ *  @param _data The raw byte to send
+ *  @returns Void.
+ */
+void swu_send(uint8_t _data);
+
+
+/* -- CALLBACKS -- */
+
+/** @brief Called from ISR context after a character has been received.
+ *
+ *  NOTE: Must be defined elsewhere (see `COMM.h`).
+ *
+ *  @returns Void.
+ */
+void swu_rx_complete(void);
+
+/** @brief Called from ISR context after a character has been sent.
+ *
+ *  NOTE: Must be defined elsewhere (see `COMM.h`).
+ *
+ *  @returns Void.
+ */
+void swu_tx_complete(void);
+
+
+#endif /* SOFT_UART_H */
@@ -0,0 +1,106 @@
+/** @file TASK.c
+ *  @brief Cooperative task scheduler
+ *
+ *  This contains the implementation for the interface described in `TASK.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "TASK.h"
+
+
+/* -- VARIABLES -- */
+
+typedef struct tsk_slot {
+  tsk_fn_t fn;     // NULL if free
+  uint32_t due;    // [ms]
+  tsk_stats_t stats;
+} tsk_slot_t;
+
+static tsk_slot_t tsk_slots[TSK_SLOTS];
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+uint8_t tsk_add(tsk_fn_t _fn, uint16_t _delay, uint16_t _period,
+                uint32_t _now) {
+  for (uint8_t _id = 0; _id < TSK_SLOTS; _id++) {
+    if (!tsk_slots[_id].fn) {
+      tsk_slots[_id] = (tsk_slot_t){
+        .fn = _fn,
+        .due = _now + _delay,
+        .stats = {.period = _period},
+      };
+      return _id;
+    }
+  }
+
+  return TSK_NONE;
+}
+
+void tsk_cancel(uint8_t _id) {
+  if (_id < TSK_SLOTS) {
+    tsk_slots[_id].fn = NULL;
+  }
+}
+
+uint8_t tsk_run(uint32_t _now) {
+  // Earliest deadline first
+  uint8_t _next = TSK_NONE;
+  for (uint8_t _id = 0; _id < TSK_SLOTS; _id++) {
+    if (tsk_slots[_id].fn && (int32_t)(_now - tsk_slots[_id].due) >= 0
+        && (_next == TSK_NONE
+            || (int32_t)(tsk_slots[_id].due - tsk_slots[_next].due) < 0)) {
+      _next = _id;
+    }
+  }
+  if (_next == TSK_NONE) {
+    return 0;
+  }
+
+  tsk_slot_t *_task = &tsk_slots[_next];
+  tsk_fn_t _fn = _task->fn;
+  uint32_t _late = _now - _task->due;
+  if (_late > _task->stats.late_ms) {
+    _task->stats.late_ms = (_late > 0xFFFF) ? 0xFFFF : _late;
+  }
+
+  // Reschedule first, so the task can cancel itself. Missed runs are skipped.
+  if (_task->stats.period) {
+    _task->due += _task->stats.period;
+    if ((int32_t)(_now - _task->due) >= 0) {
+      _task->due = _now + _task->stats.period;
+    }
+  } else {
+    _task->fn = NULL;
+  }
+
+  uint32_t _start = micros();
+  _fn();
+  uint32_t _us = micros() - _start;
+  if (_us > 0xFFFF) {
+    _us = 0xFFFF;
+  }
+
+  // Unless the slot was freed and taken by another task meanwhile
+  if (_task->fn && _task->fn != _fn) {
+    return 1;
+  }
+  _task->stats.runs++;
+  _task->stats.last_us = _us;
+  if (_us > _task->stats.max_us) {
+    _task->stats.max_us = _us;
+  }
+
+  return 1;
+}
+
+tsk_stats_t tsk_stats(uint8_t _id) {
+  if (_id >= TSK_SLOTS) {
+    return (tsk_stats_t){0};
+  }
+
+  return tsk_slots[_id].stats;
+}
@@ -0,0 +1,95 @@
+/** @file TASK.h
+ *  @brief Cooperative task scheduler
+ *
+ *  A fixed table of TSK_SLOTS tasks, each a function run once after a delay
+ *  (one-shot) or every so many milliseconds (periodic), so new periodic
+ *  work doesn't need its own `millis()` bookkeeping in the main loop.
+ *
+ *  `tsk_run()` runs at most one task per call - the due task with the
+ *  earliest deadline - so the main loop can check COMM between any two
+ *  tasks, and a packet never waits for more than the longest task. Tasks
+ *  are never interrupted, so they should do a little work and return.
+ *
+ *  A periodic task that falls behind skips the runs it missed rather than
+ *  running them back to back. Each task's runs, run time and lateness are
+ *  recorded (see `tsk_stats()`), to keep an eye on the loop's budget as
+ *  tasks are added. Run times are measured with `micros()`, so TIMER1 must
+ *  be running.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "MICROS_TIMER.h"
+
+
+/* -- CONFIGURATION -- */
+
+#define TSK_SLOTS 8
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+// Returned by `tsk_add()` when every slot is taken
+#define TSK_NONE 0xFF
+
+typedef void (*tsk_fn_t)(void);
+
+typedef struct tsk_stats {
+  uint16_t period;   // 0 for one-shot, or a free slot [ms]
+  uint16_t runs;     // Wraps at 65535
+  uint16_t last_us;  // Run time of the last run, up to 65535 [us]
+  uint16_t max_us;   // Longest run time, up to 65535 [us]
+  uint16_t late_ms;  // Most a run started after it was due [ms]
+} tsk_stats_t;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Add a task
+ *
+ *  @param _fn Function to run
+ *  @param _delay Time to the first run [ms]
+ *  @param _period Time between runs [ms], or 0 to run once
+ *  @param _now Current time, from `millis()` [ms]
+ *  @returns Task ID, or TSK_NONE if there was no free slot
+ */
+uint8_t tsk_add(tsk_fn_t _fn, uint16_t _delay, uint16_t _period,
+                uint32_t _now);
+
+/** @brief Remove a task before its next run
+ *
+ *  Safe to call from the task itself, and with TSK_NONE.
+ *
+ *  @param _id Task ID, from `tsk_add()`
+ *  @returns Void.
+ */
+void tsk_cancel(uint8_t _id);
+
+/** @brief Run the due task with the earliest deadline, if any
+ *
+ *  Call as often as possible, checking COMM in between.
+ *
+ *  @param _now Current time, from `millis()` [ms]
+ *  @returns 1 if a task was run, 0 if none was due
+ */
+uint8_t tsk_run(uint32_t _now);
+
+/** @brief Get a task's period and timings
+ *
+ *  Timings are kept until the slot is used by another task.
+ *
+ *  @param _id Task ID, from `tsk_add()`
+ *  @returns The statistics, all 0 if `_id` is out of range
+ */
+tsk_stats_t tsk_stats(uint8_t _id);
+
+
+#endif /* TASK_H */
@@ -21,6 +21,20 @@ void urt_init(uint16_t _baud) {
 	UCSR0B = (1 << TXCIE0) | (1 << RXCIE0) | (1 << TXEN0) | (1 <<  RXEN0);
 }
 
+void urt_init_mspim(uint16_t _ubrr) {
+  // Baud must be zero while the mode is switched
+  UBRR0 = 0;
+
+  // XCK as output selects master mode
+  DDRD |= (1 << DDD4);
+
+  // MSPIM, MSB first, SPI mode 0, TX only
+  UCSR0C = (1 << UMSEL01) | (1 << UMSEL00);
+  UCSR0B = (1 << TXEN0);
+
+  UBRR0 = _ubrr;
+}
+
 uint8_t urt_recv(void) {
   return UDR0;
 }
@@ -40,6 +40,20 @@
  */
 void urt_init(uint16_t _baud);
 
+/** @brief Initialize USART0 as a TX-only SPI master (MSPIM).
+ *
+ *  Data is shifted out MSB first on TXD (PD1) in SPI mode 0, with the clock on
+ *  XCK (PD4). The bit rate is F_CPU / (2 * (_ubrr + 1)), so a `_ubrr` of 1
+ *  matches `SPI_DIV_4`. Send with `urt_send()` - UDR0 is double-buffered.
+ *
+ *  NOTE: Any previous UART configuration will be overwritten. RX and all
+ *        USART interrupts are disabled.
+ *
+ *  @param _ubrr Raw value for the UBRR0 register
+ *  @returns Void.
+ */
+void urt_init_mspim(uint16_t _ubrr);
+
 /** @brief Recieves a character from the UART buffer.
  *
  *  Will return immediatly with the buffer contents.
@@ -0,0 +1,186 @@
+/** @file VM.c
+ *  @brief Bytecode interpreter for uploaded animations
+ *
+ *  This contains the implementation for the interface described in `VM.h`.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "VM.h"
+
+
+/* -- VARIABLES -- */
+
+#define VM_VALID 0xA5 // Anything but blank EEPROM
+
+uint8_t vm_program[VM_PROGRAM_SIZE];
+uint16_t vm_steps;
+
+static int16_t vm_reg[VM_NUM_REGS];
+static uint8_t vm_running = 0;
+static uint32_t vm_last;
+
+static uint8_t EEMEM vm_program_ee[VM_PROGRAM_SIZE];
+static uint8_t EEMEM vm_valid_ee;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+void vm_init(void) {
+  if (eeprom_read_byte(&vm_valid_ee) == VM_VALID) {
+    eeprom_read_block(vm_program, vm_program_ee, VM_PROGRAM_SIZE);
+  } else {
+    vm_program[0] = VM_END;
+  }
+}
+
+void vm_write(uint8_t _offset, const uint8_t *_data, uint8_t _length) {
+  vm_stop();
+  for (uint8_t _byte = 0; _byte < _length; _byte++) {
+    if (_offset + _byte >= VM_PROGRAM_SIZE) {
+      break;
+    }
+    vm_program[_offset + _byte] = _data[_byte];
+  }
+}
+
+void vm_save(void) {
+  eeprom_update_block(vm_program, vm_program_ee, VM_PROGRAM_SIZE);
+  eeprom_update_byte(&vm_valid_ee, VM_VALID);
+}
+
+void vm_start(void) {
+  for (uint8_t _reg = 0; _reg < VM_NUM_REGS; _reg++) {
+    vm_reg[_reg] = 0;
+  }
+  vm_running = 1;
+}
+
+void vm_stop(void) {
+  vm_running = 0;
+}
+
+uint8_t vm_update(uint32_t _now) {
+  if (!vm_running || (_now - vm_last) < VM_FRAME_MS) {
+    return 0;
+  }
+  vm_last = _now;
+  vm_run();
+
+  return 1;
+}
+
+uint16_t vm_run(void) {
+  uint16_t _pc = 0;
+  uint16_t _step;
+
+  // Operands past the end of the program read as 0
+  #define VM_FETCH() ((_pc < VM_PROGRAM_SIZE) ? vm_program[_pc++] : 0)
+
+  for (_step = 0; _step < VM_MAX_STEPS && _pc < VM_PROGRAM_SIZE; _step++) {
+    uint8_t _op = vm_program[_pc++];
+    uint8_t _regs = (_op == VM_END || _op == VM_JMP) ? 0 : VM_FETCH();
+    int16_t *_d = &vm_reg[_regs >> 4];
+    int16_t *_s = &vm_reg[_regs & 0x0F];
+
+    switch (_op) {
+      case VM_LDI: {
+        uint8_t _lo = VM_FETCH();
+        *_d = (int16_t)(((uint16_t)VM_FETCH() << 8) | _lo);
+      } break;
+      case VM_MOV: {
+        *_d = *_s;
+      } break;
+      case VM_ADD: {
+        *_d = (uint16_t)*_d + (uint16_t)*_s;
+      } break;
+      case VM_SUB: {
+        *_d = (uint16_t)*_d - (uint16_t)*_s;
+      } break;
+      case VM_MUL: {
+        *_d = ((int32_t)*_d * *_s) >> 8;
+      } break;
+      case VM_AND: {
+        *_d &= *_s;
+      } break;
+      case VM_SHR: {
+        *_d >>= (_regs & 0x0F);
+      } break;
+      case VM_SHL: {
+        *_d = (uint16_t)*_d << (_regs & 0x0F);
+      } break;
+      case VM_INC: {
+        *_d = (uint16_t)*_d + 1;
+      } break;
+      case VM_SIN: {
+        *_d = vm_sin(*_s);
+      } break;
+      case VM_TIME: {
+        *_d = (uint16_t)millis();
+      } break;
+      case VM_NLEDS: {
+        *_d = rgb_num_leds;
+      } break;
+      case VM_JMP: {
+        uint8_t _addr = VM_FETCH();
+        _pc = _addr;
+      } break;
+      case VM_JLT: {
+        uint8_t _addr = VM_FETCH();
+        if (*_d < *_s) {
+          _pc = _addr;
+        }
+      } break;
+      case VM_JZ: {
+        uint8_t _addr = VM_FETCH();
+        if (*_d == 0) {
+          _pc = _addr;
+        }
+      } break;
+      case VM_SET: {
+        uint8_t _rgb = VM_FETCH();
+        uint16_t _led = *_d;
+        if (_led < rgb_num_leds) {
+          rgb_set(_led, (rgb_t){
+            .red = vm_clamp(*_s),
+            .green = vm_clamp(vm_reg[_rgb >> 4]),
+            .blue = vm_clamp(vm_reg[_rgb & 0x0F]),
+          });
+        }
+      } break;
+      // END, or anything unknown
+      default: {
+        _pc = VM_PROGRAM_SIZE;
+      } break;
+    }
+  }
+
+  #undef VM_FETCH
+
+  vm_steps = _step;
+  return _step;
+}
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+static uint8_t vm_sin(uint8_t _angle) {
+  uint8_t _half = _angle & 0x7F;
+  uint8_t _peak = ((uint16_t)_half * (128 - _half)) >> 5;
+
+  if (_peak > 127) {
+    _peak = 127;
+  }
+  return (_angle & 0x80) ? 128 - _peak : 128 + _peak;
+}
+
+static uint8_t vm_clamp(int16_t _value) {
+  if (_value < 0) {
+    return 0;
+  } else if (_value > 255) {
+    return 255;
+  }
+  return _value;
+}
@@ -0,0 +1,173 @@
+/** @file VM.h
+ *  @brief Bytecode interpreter for uploaded animations
+ *
+ *  Runs a small uploaded program once per frame, writing into `rgb_led`
+ *  through `rgb_set()`. Programs are sandboxed: registers, jumps and LED
+ *  numbers are all range-checked, and a frame is cut short after
+ *  VM_MAX_STEPS instructions, so a bad program can only draw garbage.
+ *
+ *  The machine has 16 signed 16-bit registers (r0-r15), kept between frames
+ *  and cleared by `vm_start()`. Arithmetic wraps, except MUL, which treats
+ *  both registers as 8.8 fixed point. Each instruction is an opcode byte
+ *  followed by 0-3 operand bytes. Registers are packed two to a byte, first
+ *  operand in the high nibble (written `d,s` below). Jump targets are
+ *  absolute program offsets.
+ *
+ *  | Opcode   | Operands        | Effect                                 |
+ *  |----------|-----------------|----------------------------------------|
+ *  | END      |                 | End of frame                           |
+ *  | LDI      | d, lo, hi       | d = imm16                              |
+ *  | MOV      | d,s             | d = s                                  |
+ *  | ADD      | d,s             | d = d + s                              |
+ *  | SUB      | d,s             | d = d - s                              |
+ *  | MUL      | d,s             | d = (d * s) >> 8                       |
+ *  | AND      | d,s             | d = d & s                              |
+ *  | SHR      | d,n             | d = d >> n (arithmetic)                |
+ *  | SHL      | d,n             | d = d << n                             |
+ *  | INC      | d               | d = d + 1                              |
+ *  | SIN      | d,s             | d = sine of low byte of s, 0-255       |
+ *  | TIME     | d               | d = low 16 bits of `millis()`          |
+ *  | NLEDS    | d               | d = `rgb_num_leds`                     |
+ *  | JMP      | addr            | Jump                                   |
+ *  | JLT      | a,b, addr       | Jump if a < b                          |
+ *  | JZ       | d, addr         | Jump if d == 0                         |
+ *  | SET      | i,r, g,b        | LED i = (r, g, b), each clamped 0-255  |
+ *
+ *  `tools/vmasm.py` assembles programs from text.
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#ifndef VM_H
+#define VM_H
+
+#include <avr/eeprom.h>
+#include <stdint.h>
+
+#include "MILLIS_TIMER.h"
+#include "RGB_LED.h"
+
+
+/* -- CONFIGURATION -- */
+
+#define VM_PROGRAM_SIZE 128
+#define VM_NUM_REGS     16
+#define VM_MAX_STEPS    4096 // Per frame
+#define VM_FRAME_MS     20   // [ms] - 50 FPS
+
+
+/* -- VARIABLES & DEFINITIONS -- */
+
+typedef enum vm_op {
+  VM_END,
+  VM_LDI,
+  VM_MOV,
+  VM_ADD,
+  VM_SUB,
+  VM_MUL,
+  VM_AND,
+  VM_SHR,
+  VM_SHL,
+  VM_INC,
+  VM_SIN,
+  VM_TIME,
+  VM_NLEDS,
+  VM_JMP,
+  VM_JLT,
+  VM_JZ,
+  VM_SET,
+} vm_op_t;
+
+// Uploaded program - write with `vm_write()`
+extern uint8_t vm_program[VM_PROGRAM_SIZE];
+
+// Instructions run in the last frame (VM_MAX_STEPS if it was cut short)
+extern uint16_t vm_steps;
+
+
+/* -- PUBLIC FUNCTIONS -- */
+
+/** @brief Load the saved program from EEPROM
+ *
+ *  Leaves `vm_program` empty (a single END) if nothing valid was saved.
+ *
+ *  @returns Void.
+ */
+void vm_init(void);
+
+/** @brief Write part of the program
+ *
+ *  Stops the VM, so a half-written program never runs. Bytes past
+ *  VM_PROGRAM_SIZE are dropped.
+ *
+ *  @param _offset Where in `vm_program` to start writing
+ *  @param _data Bytes to write
+ *  @param _length Number of bytes to write
+ *  @returns Void.
+ */
+void vm_write(uint8_t _offset, const uint8_t *_data, uint8_t _length);
+
+/** @brief Save the program to EEPROM
+ *
+ *  Blocks for the EEPROM writes (~3.4ms per changed byte).
+ *
+ *  @returns Void.
+ */
+void vm_save(void);
+
+/** @brief Clear the registers and start running the program
+ *
+ *  @returns Void.
+ */
+void vm_start(void);
+
+/** @brief Stop running the program
+ *
+ *  LEDs are left as they were in the last frame.
+ *
+ *  @returns Void.
+ */
+void vm_stop(void);
+
+/** @brief Run the program for the next frame, if one is due
+ *
+ *  Call as often as possible. Runs at most one frame every VM_FRAME_MS.
+ *  Does not push.
+ *
+ *  @param _now Current time, from `millis()` [ms]
+ *  @returns 1 if a frame was drawn (and should be pushed), 0 otherwise
+ */
+uint8_t vm_update(uint32_t _now);
+
+/** @brief Run the program once, from the start
+ *
+ *  Runs until END, the end of the program, a bad instruction, or
+ *  VM_MAX_STEPS instructions. Runs whether or not the VM is started.
+ *
+ *  @returns Number of instructions run (also left in `vm_steps`)
+ */
+uint16_t vm_run(void);
+
+
+/* -- PRIVATE FUNCTIONS -- */
+
+/** @brief Sine of an angle, for the SIN instruction
+ *
+ *  Parabolic approximation, within ~6% of a true sine.
+ *
+ *  @param _angle 0-255 for one full turn
+ *  @returns 128 + 127 * sin(_angle)
+ */
+static uint8_t vm_sin(uint8_t _angle);
+
+/** @brief Clamp a register to a channel value
+ *
+ *  @param _value Register value
+ *  @returns `_value` limited to 0-255
+ */
+static uint8_t vm_clamp(int16_t _value);
+
+
+#endif /* VM_H */
@@ -0,0 +1,179 @@
+"""Compress a frame file into a flash-resident animation for ANIM_DATA.c.
+
+The frame file is text, one frame per line, one RRGGBB hex colour per LED,
+separated by spaces. Blank lines and anything after `#` are ignored:
+
+    # Two LEDs, blinking red
+    FF0000 000000
+    000000 FF0000
+
+Every frame must have the same number of LEDs. The first frame is stored
+whole, and every later frame only as its changes from the one before, using
+the ops described in `src/ANIM.h`. Playback loops back to the first frame.
+
+Run from the ARCHON-avr folder (or use `make anim ANIM=frames.txt`):
+    python3 tools/anim.py frames.txt > src/ANIM_DATA.c
+"""
+import argparse
+import sys
+
+# Ops - must match `src/ANIM.h`
+OP_SKIP = 0x00
+OP_RUN = 0x40
+OP_LITERAL = 0x80
+OP_FRAME = 0xC0
+OP_END = 0xFF
+MAX_COUNT = 64
+
+HEADER = """/** @file ANIM_DATA.c
+ *  @brief Flash-resident animation.
+ *
+ *  This contains the stream described in `ANIM.h`.
+ *
+ *  NOTE: Generated by `tools/anim.py` - do not edit by hand. Source:
+ *        {source}, {frames} frames of {leds} LEDs at {frame_ms} ms,
+ *        {size} bytes ({raw} uncompressed)
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "ANIM.h"
+"""
+
+
+def parse_frames(text: str) -> list:
+    """Parse a frame file.
+
+    @param text Frame file contents.
+
+    @returns List of frames, each a list of (r, g, b) tuples.
+
+    @raises ValueError On bad colours, or frames of different lengths.
+    """
+    frames = []
+    for number, line in enumerate(text.splitlines(), 1):
+        line = line.split("#")[0].strip()
+        if not line:
+            continue
+        try:
+            frame = [tuple(bytes.fromhex(colour)) for colour in line.split()]
+        except ValueError:
+            raise ValueError("line {}: bad colour".format(number))
+        if any(len(colour) != 3 for colour in frame):
+            raise ValueError("line {}: colours are RRGGBB".format(number))
+        if frames and len(frame) != len(frames[0]):
+            raise ValueError("line {}: {} LEDs, expected {}".format(
+                number, len(frame), len(frames[0])))
+        frames.append(frame)
+
+    if not frames:
+        raise ValueError("no frames")
+
+    return frames
+
+
+def run_length(frame: list, start: int) -> int:
+    """Count LEDs from `start` that share its colour.
+
+    @param frame List of colours.
+    @param start First LED.
+
+    @returns Length of the run, at least 1.
+
+    @raises None.
+    """
+    end = start + 1
+    while end < len(frame) and frame[end] == frame[start]:
+        end += 1
+
+    return end - start
+
+
+def encode_frame(frame: list, previous: list) -> list:
+    """Encode one frame as ops against the one before.
+
+    @param frame List of colours to show.
+    @param previous List of colours already shown, or None for a keyframe.
+
+    @returns List of bytes, ending in OP_FRAME.
+
+    @raises None.
+    """
+    out = []
+    led = 0
+    while led < len(frame):
+        # Unchanged - always worth skipping, literals cost 3 bytes per LED
+        if previous and frame[led] == previous[led]:
+            count = 1
+            while (led + count < len(frame) and count < MAX_COUNT
+                   and frame[led + count] == previous[led + count]):
+                count += 1
+            out.append(OP_SKIP | (count - 1))
+        # Two or more the same - one colour for all of them
+        elif run_length(frame, led) > 1:
+            count = min(run_length(frame, led), MAX_COUNT)
+            out.append(OP_RUN | (count - 1))
+            out += frame[led]
+        # Changed LEDs that don't start a run
+        else:
+            count = 1
+            while (led + count < len(frame) and count < MAX_COUNT
+                   and not (previous and frame[led + count]
+                            == previous[led + count])
+                   and run_length(frame, led + count) == 1):
+                count += 1
+            out.append(OP_LITERAL | (count - 1))
+            for colour in frame[led:led + count]:
+                out += colour
+        led += count
+    out.append(OP_FRAME)
+
+    return out
+
+
+def encode(frames: list, frame_ms: int) -> list:
+    """Encode a whole animation.
+
+    @param frames List of frames.
+    @param frame_ms Time each frame is shown [ms].
+
+    @returns List of bytes.
+
+    @raises None.
+    """
+    stream = [frame_ms >> 8, frame_ms & 0xFF]
+    previous = None
+    for frame in frames:
+        stream += encode_frame(frame, previous)
+        previous = frame
+    stream.append(OP_END)
+
+    return stream
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Animation compressor")
+    parser.add_argument("source", type=argparse.FileType("r"))
+    parser.add_argument("--frame-ms", type=int, default=40,
+                        help="time each frame is shown [ms] (default 40)")
+    args = parser.parse_args()
+
+    if not 1 <= args.frame_ms <= 0xFFFF:
+        sys.exit("--frame-ms must be 1-65535")
+    try:
+        frames = parse_frames(args.source.read())
+    except ValueError as err:
+        sys.exit(str(err))
+    stream = encode(frames, args.frame_ms)
+
+    print(HEADER.format(source=args.source.name, frames=len(frames),
+                        leds=len(frames[0]), frame_ms=args.frame_ms,
+                        size=len(stream), raw=len(frames) * len(frames[0]) * 3))
+    print()
+    print("const uint8_t anm_stream[] PROGMEM = {")
+    for i in range(0, len(stream), 12):
+        print("  " + ", ".join(
+            "0x{:02X}".format(b) for b in stream[i:i + 12]) + ",")
+    print("};")
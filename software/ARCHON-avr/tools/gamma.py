@@ -0,0 +1,87 @@
+"""Generate per-channel gamma lookup tables for GAMMA.c.
+
+Each table maps an 8-bit linear channel value onto the 8-bit value that
+should be sent to the LEDs:
+
+    out = round(max * (in / 255) ** gamma)
+
+Run from the ARCHON-avr folder (or use `make gamma`):
+    python3 tools/gamma.py > src/GAMMA.c
+"""
+import argparse
+import textwrap
+
+CHANNELS = ["red", "green", "blue", "white"]
+
+HEADER = """/** @file GAMMA.c
+ *  @brief Per-channel gamma lookup tables.
+ *
+ *  This contains the tables described in `GAMMA.h`.
+ *
+ *  NOTE: Generated by `tools/gamma.py` - do not edit by hand. Arguments:
+{args}
+ *
+ *  @author Patrick Dunham
+ *  @bug No known bugs.
+ *  @version 0.0.1
+ */
+
+#include "GAMMA.h"
+"""
+
+
+def gamma_table(gamma: float, maximum: int) -> list:
+    """Calculate a 256-entry gamma table.
+
+    @param gamma Gamma exponent to apply.
+    @param maximum Output value for a full-scale input (0-255).
+
+    @returns List of 256 ints.
+
+    @raises None.
+    """
+    return [int(round(maximum * (i / 255.0) ** gamma)) for i in range(256)]
+
+
+def format_table(name: str, table: list) -> str:
+    """Format a table as a PROGMEM C array, 16 entries per line.
+
+    @param name Channel name, used as the `gam_<name>` array suffix.
+    @param table List of 256 ints.
+
+    @returns C source for the table.
+
+    @raises None.
+    """
+    lines = ["const uint8_t gam_{}[256] PROGMEM = {{".format(name)]
+    for i in range(0, 256, 16):
+        lines.append("  " + ", ".join(
+            "{:3d}".format(v) for v in table[i:i + 16]) + ",")
+    lines.append("};")
+
+    return "\n".join(lines)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Gamma table generator")
+
+    for channel in CHANNELS:
+        parser.add_argument("--{}-gamma".format(channel), type=float,
+                            default=2.6)
+        parser.add_argument("--{}-max".format(channel), type=int,
+                            default=255)
+
+    args = parser.parse_args()
+    settings = vars(args)
+
+    arg_text = " ".join("--{} {}".format(k.replace("_", "-"), v)
+                        for k, v in sorted(settings.items()))
+    print(HEADER.format(args="\n".join(
+        textwrap.wrap(arg_text, width=80, initial_indent=" *        ",
+                      subsequent_indent=" *        "))))
+
+    for channel in CHANNELS:
+        print()
+        print(format_table(channel, gamma_table(
+            settings["{}_gamma".format(channel)],
+            settings["{}_max".format(channel)])))
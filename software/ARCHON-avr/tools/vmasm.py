@@ -0,0 +1,186 @@
+"""Assemble text programs for the bytecode VM (see src/VM.h).
+
+One instruction per line, operands separated by commas. Registers are r0-r15,
+immediates may be decimal or 0x hex, and jump targets may be labels
+(`name:` on a line of their own). Anything after `;` is a comment:
+
+    ; Rainbow
+            NLEDS r2
+            TIME  r1
+            SHR   r1, 3
+            LDI   r0, 0
+    loop:   MOV   r3, r1
+            SIN   r4, r3
+            ...
+            SET   r0, r4, r5, r6
+            INC   r0
+            JLT   r0, r2, loop
+            END
+
+Prints the program as hex bytes. Upload it in chunks with
+COM_PKT_VM_DATA (<OFFSET><BYTE_0>...), then start it with LED_CTRL VM.
+
+Run from the ARCHON-avr folder:
+    python3 tools/vmasm.py program.vm
+"""
+import argparse
+import sys
+
+PROGRAM_SIZE = 128
+
+# Opcode, then operand layout: "r" register pair byte (high nibble first),
+# "R" single register, "n" register + 4-bit immediate, "w" 16-bit immediate,
+# "a" jump target. Must match `vm_op_t`.
+OPCODES = {
+    "END":   (0x00, ""),
+    "LDI":   (0x01, "Rw"),
+    "MOV":   (0x02, "rr"),
+    "ADD":   (0x03, "rr"),
+    "SUB":   (0x04, "rr"),
+    "MUL":   (0x05, "rr"),
+    "AND":   (0x06, "rr"),
+    "SHR":   (0x07, "Rn"),
+    "SHL":   (0x08, "Rn"),
+    "INC":   (0x09, "R"),
+    "SIN":   (0x0A, "rr"),
+    "TIME":  (0x0B, "R"),
+    "NLEDS": (0x0C, "R"),
+    "JMP":   (0x0D, "a"),
+    "JLT":   (0x0E, "rra"),
+    "JZ":    (0x0F, "Ra"),
+    "SET":   (0x10, "rrrr"),
+}
+
+
+def parse_lines(text: str) -> list:
+    """Split source into (line number, label, mnemonic, operands) tuples.
+
+    @param text Program source.
+
+    @returns List of tuples. Label and mnemonic may be None.
+
+    @raises None.
+    """
+    lines = []
+    for number, line in enumerate(text.splitlines(), 1):
+        line = line.split(";")[0].strip()
+        label = None
+        if ":" in line:
+            label, line = (part.strip() for part in line.split(":", 1))
+        if not line:
+            lines.append((number, label, None, []))
+            continue
+        fields = line.split(None, 1)
+        operands = [op.strip() for op in fields[1].split(",")] \
+            if len(fields) > 1 else []
+        lines.append((number, label, fields[0].upper(), operands))
+
+    return lines
+
+
+def register(text: str) -> int:
+    """Parse a register name.
+
+    @param text Operand, e.g. "r3".
+
+    @returns Register number.
+
+    @raises ValueError If not a register.
+    """
+    if text[:1].lower() != "r" or not 0 <= int(text[1:]) < 16:
+        raise ValueError("expected a register, got '{}'".format(text))
+
+    return int(text[1:])
+
+
+def encode(mnemonic: str, operands: list, labels: dict) -> list:
+    """Encode one instruction.
+
+    @param mnemonic Upper-case instruction name.
+    @param operands Operand strings.
+    @param labels Label name to program offset.
+
+    @returns List of bytes.
+
+    @raises ValueError On unknown instructions or bad operands.
+    """
+    if mnemonic not in OPCODES:
+        raise ValueError("unknown instruction '{}'".format(mnemonic))
+    opcode, layout = OPCODES[mnemonic]
+    if len(operands) != len(layout):
+        raise ValueError("{} takes {} operands".format(mnemonic, len(layout)))
+
+    out = [opcode]
+    nibbles = []
+    for kind, text in zip(layout, operands):
+        if kind in "rR":
+            nibbles.append(register(text))
+        elif kind == "n":
+            nibbles.append(int(text, 0) & 0x0F)
+        elif kind == "w":
+            value = int(text, 0) & 0xFFFF
+            out += [value & 0xFF, value >> 8]
+        elif kind == "a":
+            out.append(labels[text] if text in labels else int(text, 0))
+
+    # Single registers take the high nibble
+    if len(nibbles) % 2:
+        nibbles.append(0)
+    regs = [(nibbles[i] << 4) | nibbles[i + 1]
+            for i in range(0, len(nibbles), 2)]
+
+    # Register bytes always come straight after the opcode
+    return out[:1] + regs + out[1:]
+
+
+def assemble(text: str) -> list:
+    """Assemble a whole program.
+
+    @param text Program source.
+
+    @returns List of bytes.
+
+    @raises ValueError On any error, with the line number.
+    """
+    lines = parse_lines(text)
+
+    # First pass - instruction sizes, for label offsets
+    labels = {}
+    offset = 0
+    for number, label, mnemonic, operands in lines:
+        if label:
+            labels[label] = offset
+        if mnemonic:
+            try:
+                offset += len(encode(mnemonic, operands,
+                                     {k: 0 for k in operands}))
+            except ValueError as err:
+                raise ValueError("line {}: {}".format(number, err))
+
+    program = []
+    for number, label, mnemonic, operands in lines:
+        if mnemonic:
+            try:
+                program += encode(mnemonic, operands, labels)
+            except (ValueError, KeyError) as err:
+                raise ValueError("line {}: {}".format(number, err))
+
+    if len(program) > PROGRAM_SIZE:
+        raise ValueError("program is {} bytes, limit is {}".format(
+            len(program), PROGRAM_SIZE))
+
+    return program
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="VM program assembler")
+    parser.add_argument("source", type=argparse.FileType("r"))
+    args = parser.parse_args()
+
+    try:
+        program = assemble(args.source.read())
+    except ValueError as err:
+        sys.exit(str(err))
+
+    for i in range(0, len(program), 16):
+        print(" ".join("{:02X}".format(b) for b in program[i:i + 16]))